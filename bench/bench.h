@@ -0,0 +1,119 @@
+#ifndef BENCH_BENCH_H_
+#define BENCH_BENCH_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+#ifndef BENCH_VARIANT
+#define BENCH_VARIANT "default"
+#endif
+
+// Minimal benchmark harness. Every benchmark binary includes this header
+// exactly once; it replaces the global allocation functions to count heap
+// allocations and reports results as one JSON object per line.
+
+namespace bench {
+
+inline std::atomic<std::size_t> num_allocations(0);
+
+struct Result {
+  std::string name;
+  std::size_t num_ops = 0;
+  std::size_t num_steps = 0;
+  std::size_t num_allocations = 0;
+  double seconds = 0.0;
+};
+
+// Keeps the compiler from discarding or hoisting the computation of `value`.
+template <typename T>
+inline void DoNotOptimize(T& value) {
+  asm volatile("" : "+m"(value) : : "memory");
+}
+
+// Calls `op` until at least `min_seconds` have passed. `op` returns the number
+// of simulated steps it performed, or zero if steps do not apply.
+template <typename Op>
+const Result Run(const std::string& name, Op&& op,
+                 const double min_seconds = 0.5) {
+  // Warm up caches and lazily sized buffers.
+  op();
+
+  auto result = Result();
+  result.name = name;
+
+  auto allocations = num_allocations.load(std::memory_order_relaxed);
+  auto start = std::chrono::steady_clock::now();
+  auto elapsed = std::chrono::duration<double>::zero();
+  do {
+    result.num_steps += op();
+    ++result.num_ops;
+    elapsed = std::chrono::steady_clock::now() - start;
+  } while (elapsed.count() < min_seconds);
+
+  result.seconds = elapsed.count();
+  result.num_allocations =
+      num_allocations.load(std::memory_order_relaxed) - allocations;
+
+  return result;
+}
+
+inline void Report(const Result& result) {
+  auto ns_per_op = result.seconds * 1e9 / result.num_ops;
+
+  std::cout << "{\"benchmark\":\"" << result.name << "\",\"variant\":\""
+            << BENCH_VARIANT << "\",\"ops\":" << result.num_ops
+            << ",\"ns_per_op\":" << ns_per_op
+            << ",\"ops_per_sec\":" << result.num_ops / result.seconds;
+  if (result.num_steps > 0) {
+    std::cout << ",\"ns_per_step\":"
+              << result.seconds * 1e9 / result.num_steps;
+  }
+  std::cout << ",\"allocs_per_op\":"
+            << static_cast<double>(result.num_allocations) / result.num_ops
+            << "}" << std::endl;
+}
+
+}  // namespace bench
+
+// The replacements are kept out of line so that the compiler does not pair
+// the standard operator new with the free inlined from them.
+[[gnu::noinline]] void* operator new(const std::size_t size) {
+  bench::num_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (auto* ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+
+  throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void* operator new(const std::size_t size,
+                                     const std::align_val_t alignment) {
+  bench::num_allocations.fetch_add(1, std::memory_order_relaxed);
+  auto align = static_cast<std::size_t>(alignment);
+  auto rounded = ((size == 0 ? 1 : size) + align - 1) / align * align;
+  if (auto* ptr = std::aligned_alloc(align, rounded)) {
+    return ptr;
+  }
+
+  throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* ptr) noexcept { std::free(ptr); }
+[[gnu::noinline]] void operator delete(void* ptr, const std::size_t) noexcept {
+  std::free(ptr);
+}
+[[gnu::noinline]] void operator delete(void* ptr,
+                                       const std::align_val_t) noexcept {
+  std::free(ptr);
+}
+[[gnu::noinline]] void operator delete(void* ptr, const std::size_t,
+                                       const std::align_val_t) noexcept {
+  std::free(ptr);
+}
+
+#endif  // BENCH_BENCH_H_
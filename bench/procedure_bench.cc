@@ -0,0 +1,250 @@
+#include <cstddef>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "bench.h"
+#include "control/plant_control.h"
+#include "control/solver.h"
+#include "ga/island_model.h"
+#include "ga/work_pool.h"
+
+namespace {
+
+using Solver = control::Solver<double, 3>;
+
+constexpr const double kUnbounded = std::numeric_limits<double>::infinity();
+
+const std::vector<Solver::bounds_type> Constraints() {
+  return {Solver::bounds_type(2, 18), Solver::bounds_type(1.05, 9.42),
+          Solver::bounds_type(0.26, 2.37)};
+}
+
+// Exposes the solver's operators to the benchmarks.
+class BenchSolver : public Solver {
+ public:
+  BenchSolver(const Args& args) : Solver(args, Constraints()) {
+    log_file_name().clear();
+    ReserveWorkers(1);
+  }
+
+  using Solver::batch_size;
+  using Solver::Fitness;
+  using Solver::FitnessBatch;
+  using Solver::RandomGeneration;
+  using Solver::ReserveWorkers;
+  using Solver::SelectParents;
+  using Solver::Parent;
+  using Solver::WholeArithmeticCrossover;
+};
+
+}  // namespace
+
+int main() {
+  auto args = Solver::Args();
+  args.cache_capacity = 0;
+  args.bounded_evaluation = false;
+
+  auto solver = BenchSolver(args);
+  auto generation = solver.RandomGeneration();
+  for (auto& chromosome : generation) {
+    chromosome.fitness() = solver.Fitness(chromosome, 0, kUnbounded);
+  }
+
+  auto plant_control = control::PlantControl();
+  auto recorded = plant_control.StepResponse();
+
+  bench::Report(bench::Run("plant_control/step_response", [&]() {
+    return plant_control.StepResponse().num_samples;
+  }));
+
+  bench::Report(bench::Run("plant_control/step_response_metrics", [&]() {
+    return plant_control.StepResponse(false).num_samples;
+  }));
+
+  bench::Report(bench::Run("plant_control/integral_squared_error", [&]() {
+    bench::DoNotOptimize(recorded);
+    auto ise = control::PlantControl::IntegralSquaredError(recorded);
+    bench::DoNotOptimize(ise);
+    return recorded.time_values.size();
+  }));
+
+  std::size_t i = 0;
+  bench::Report(bench::Run("solver/fitness", [&]() {
+    auto& chromosome = generation[i++ % generation.size()];
+    chromosome.fitness() = solver.Fitness(chromosome, 0, kUnbounded);
+    return control::PlantControl::kNumSamples;
+  }));
+
+  auto pointers = std::vector<Solver::chromosome_type*>();
+  for (auto& chromosome : generation) {
+    pointers.push_back(&chromosome);
+  }
+
+  bench::Report(bench::Run("solver/fitness_batch", [&]() {
+    auto first = (i++ * Solver::kBatchSize) % generation.size();
+    auto count = std::min(Solver::kBatchSize, generation.size() - first);
+    solver.FitnessBatch(&pointers[first], count, 0, kUnbounded);
+    return count * control::PlantControl::kNumSamples;
+  }));
+
+  auto float_solver = BenchSolver(args);
+  float_solver.precision() = control::Precision::kFloat;
+  float_solver.ReserveWorkers(1);
+
+  bench::Report(bench::Run("solver/fitness_float", [&]() {
+    auto& chromosome = generation[i++ % generation.size()];
+    chromosome.fitness() = float_solver.Fitness(chromosome, 0, kUnbounded);
+    return control::PlantControl::kNumSamples;
+  }));
+
+  bench::Report(bench::Run("solver/fitness_batch_float", [&]() {
+    auto first = (i++ * Solver::kFloatBatchSize) % generation.size();
+    auto count = std::min(Solver::kFloatBatchSize, generation.size() - first);
+    float_solver.FitnessBatch(&pointers[first], count, 0, kUnbounded);
+    return count * control::PlantControl::kNumSamples;
+  }));
+
+  // Four scenarios per chromosome, four chromosomes per batch. The second
+  // run bounds their mean at a fitness that only good controllers reach in
+  // every scenario.
+  auto scenario_solver = BenchSolver(args);
+  scenario_solver.scenarios() = {
+      control::Scenario(), control::Scenario(2.0),
+      control::Scenario(1.0, 0.1),
+      control::Scenario(1.0, control::Plant::kEpsilon,
+                        control::Plant::Disturbance(0.5, 50.0))};
+  auto scenario_batch_size = scenario_solver.batch_size();
+
+  for (const auto cost_bound : {kUnbounded, 5.0}) {
+    auto result = bench::Run(
+        cost_bound == kUnbounded ? "solver/fitness_batch_scenarios"
+                                 : "solver/fitness_batch_scenarios_bounded",
+        [&]() {
+          auto first = (i++ * scenario_batch_size) % generation.size();
+          auto count = std::min(scenario_batch_size, generation.size() - first);
+          scenario_solver.FitnessBatch(&pointers[first], count, 0, cost_bound);
+          return std::size_t(0);
+        });
+    bench::Report(result);
+  }
+
+  auto parents = std::vector<BenchSolver::Parent>();
+  bench::Report(bench::Run("procedure/select_parents", [&]() {
+    solver.SelectParents(generation, parents);
+    bench::DoNotOptimize(parents);
+    return std::size_t(0);
+  }));
+
+  auto offspring = std::vector<Solver::chromosome_type>(2 * parents.size());
+
+  bench::Report(bench::Run("procedure/whole_arithmetic_crossover", [&]() {
+    solver.WholeArithmeticCrossover(parents, offspring, 0);
+    bench::DoNotOptimize(offspring);
+    return std::size_t(0);
+  }));
+
+  // Whole runs with the default settings; one op is one generation.
+  for (const auto num_workers : {std::size_t(1), std::size_t(0)}) {
+    auto run_args = Solver::Args();
+    run_args.num_generations = 20;
+    run_args.num_workers = num_workers;
+
+    auto result = bench::Run(
+        num_workers == 1 ? "procedure/generation"
+                         : "procedure/generation_all_workers",
+        [&]() {
+          auto run = BenchSolver(run_args);
+          run.Start();
+          return std::size_t(0);
+        });
+
+    result.num_ops *= run_args.num_generations + 1;
+    bench::Report(result);
+  }
+
+  // The same on a warm WorkPool, as the tuning daemon runs them, instead of
+  // threads started for every evaluation.
+  {
+    auto pool = ga::WorkPool();
+    auto run_args = Solver::Args();
+    run_args.num_generations = 20;
+    run_args.num_workers = 0;
+
+    auto result = bench::Run("procedure/generation_work_pool", [&]() {
+      auto run = BenchSolver(run_args);
+      run.set_executor(&pool);
+      run.Start();
+      return std::size_t(0);
+    });
+
+    result.num_ops *= run_args.num_generations + 1;
+    bench::Report(result);
+  }
+
+  // The same on islands, one thread each, exchanging migrants; one op is one
+  // generation of one island.
+  {
+    auto run_args = Solver::Args();
+    run_args.num_generations = 20;
+    run_args.seed = 1;
+    auto island_args = ga::IslandModel<Solver>::Args();
+
+    auto result = bench::Run("procedure/generation_island_threads", [&]() {
+      auto model =
+          ga::IslandModel<Solver>(island_args, run_args, Constraints());
+      model.log_file_name().clear();
+      model.Start();
+      return std::size_t(0);
+    });
+
+    result.num_ops *= island_args.num_islands * (run_args.num_generations + 1);
+    bench::Report(result);
+  }
+
+  // The same with multi-fidelity evaluation, fully evaluating half of the
+  // offspring, and with the surrogate, simulating a quarter of them.
+  for (const auto surrogate : {false, true}) {
+    auto run_args = Solver::Args();
+    run_args.num_generations = 20;
+    if (surrogate) {
+      run_args.surrogate_fraction = 0.25;
+    } else {
+      run_args.screening_fraction = 0.5;
+    }
+
+    auto result = bench::Run(
+        surrogate ? "procedure/generation_surrogate"
+                  : "procedure/generation_screening",
+        [&]() {
+          auto run = BenchSolver(run_args);
+          run.Start();
+          return std::size_t(0);
+        });
+
+    result.num_ops *= run_args.num_generations + 1;
+    bench::Report(result);
+  }
+
+  // Bounded evaluation must only change the cost of a run, never its result.
+  for (const auto selection :
+       {Solver::Selection::kFitnessProportionate, Solver::Selection::kTournament,
+        Solver::Selection::kRank}) {
+    for (std::size_t seed = 1; seed <= 4; ++seed) {
+      auto run_args = Solver::Args();
+      run_args.num_generations = 60;
+      run_args.seed = seed;
+      run_args.selection = selection;
+
+      auto bounded = BenchSolver(run_args).Start();
+      run_args.bounded_evaluation = false;
+      auto unbounded = BenchSolver(run_args).Start();
+      if (bounded.fitness() != unbounded.fitness()) {
+        std::cerr << "Bounded and unbounded runs differ" << std::endl;
+        return 1;
+      }
+    }
+  }
+
+  return 0;
+}
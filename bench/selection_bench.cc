@@ -0,0 +1,135 @@
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "ga/procedure.h"
+
+namespace {
+
+using Procedure = ga::Procedure<double, 3>;
+using Chromosome = Procedure::chromosome_type;
+
+// Exposes the selection of a procedure that never simulates anything.
+class BenchProcedure : public Procedure {
+ public:
+  BenchProcedure(const Args& args) : Procedure(args) {}
+
+  using Procedure::Parent;
+  using Procedure::SelectParents;
+
+ protected:
+  constexpr const double Fitness(const Chromosome& /*chromosome*/,
+                                 const std::size_t /*worker*/,
+                                 const double /*cost_bound*/) final {
+    return 0.0;
+  }
+};
+
+// The selection this replaced: cumulative probabilities, a sort, and a fresh
+// draw per chromosome while scanning for each parent.
+class LegacySelection {
+ public:
+  using Parent = BenchProcedure::Parent;
+
+  const std::vector<Parent> SelectParentsFPS(
+      std::vector<Chromosome>& generation) {
+    double sum_of_fitness = 0.0;
+    for (const auto& chromosome : generation) {
+      sum_of_fitness += chromosome.fitness();
+    }
+
+    double prev_pr = 0.0;
+    for (auto& chromosome : generation) {
+      double selection_pr = prev_pr + (chromosome.fitness() / sum_of_fitness);
+
+      chromosome.selection_pr() = selection_pr;
+      prev_pr = selection_pr;
+    }
+
+    std::sort(generation.begin(), generation.end(),
+              [](const Chromosome& c1, const Chromosome& c2) {
+                return c1.selection_pr() < c2.selection_pr();
+              });
+
+    auto parents = std::vector<Parent>((generation.size() - 2) / 2);
+    for (auto& parent : parents) {
+      parent = SelectParent(generation);
+    }
+
+    return parents;
+  }
+
+ private:
+  const Parent SelectParent(const std::vector<Chromosome>& generation) {
+    auto parent = Parent();
+    auto dis = std::uniform_real_distribution<>();
+
+    for (const auto& chromosome : generation) {
+      if (dis(mt_) < chromosome.selection_pr()) {
+        if (!parent.first) {
+          parent.first = &chromosome;
+        } else {
+          parent.second = &chromosome;
+          break;
+        }
+      }
+    }
+
+    return parent;
+  }
+
+  std::mt19937_64 mt_;
+};
+
+const std::vector<Chromosome> RandomGeneration(const std::size_t size) {
+  auto mt = std::mt19937_64(size);
+  auto dis = std::uniform_real_distribution<>(1.0, 50.0);
+
+  auto generation = std::vector<Chromosome>(size);
+  for (auto& chromosome : generation) {
+    chromosome.randomize(mt);
+    chromosome.fitness() = dis(mt);
+  }
+
+  return generation;
+}
+
+}  // namespace
+
+int main() {
+  for (const std::size_t size : {50, 1000, 10000}) {
+    auto suffix = std::string("/").append(std::to_string(size));
+    auto generation = RandomGeneration(size);
+
+    auto legacy = LegacySelection();
+    bench::Report(bench::Run("selection/legacy_fps" + suffix, [&]() {
+      auto parents = legacy.SelectParentsFPS(generation);
+      bench::DoNotOptimize(parents);
+      return std::size_t(0);
+    }));
+
+    for (const auto selection : {Procedure::Selection::kFitnessProportionate,
+                                 Procedure::Selection::kTournament,
+                                 Procedure::Selection::kRank}) {
+      auto args = Procedure::Args(size);
+      args.selection = selection;
+      auto procedure = BenchProcedure(args);
+
+      auto name = selection == Procedure::Selection::kTournament
+                      ? "selection/tournament"
+                      : (selection == Procedure::Selection::kRank
+                             ? "selection/rank"
+                             : "selection/fps");
+      auto parents = std::vector<BenchProcedure::Parent>();
+      bench::Report(bench::Run(name + suffix, [&]() {
+        procedure.SelectParents(generation, parents);
+        bench::DoNotOptimize(parents);
+        return std::size_t(0);
+      }));
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,151 @@
+#include <cstddef>
+#include <iostream>
+
+#include "bench.h"
+#include "control/batch_plant_control.h"
+#include "control/plant_control.h"
+#include "control/state_space_plant.h"
+
+namespace {
+
+// Runs one step response of `system` with a slightly different gain each
+// time and returns the number of simulated samples.
+template <typename S>
+const std::size_t StepResponse(S& system, std::size_t& run, double& checksum) {
+  system.controller().params().k_p =
+      control::Controller::Parameters::kDefaultKp + 0.01 * (run++ % 100);
+
+  auto response = system.StepResponse(false);
+  checksum += response.integral_squared_error;
+
+  return response.num_samples;
+}
+
+// Drives `plant` open loop with a unit step for one simulation and returns
+// the number of samples. Unlike the closed loops, whose controller state
+// decays into subnormal numbers, this measures the plant update alone.
+template <typename P>
+const std::size_t PlantStepResponse(P& plant, double& checksum) {
+  plant.reset();
+  for (std::size_t i = 0; i < control::PlantControl::kNumSamples; ++i) {
+    checksum += plant.update_output(1.0);
+  }
+
+  return control::PlantControl::kNumSamples;
+}
+
+// The same for K lanes of plants, a pack at a time.
+template <typename P, std::size_t K>
+const std::size_t PlantLanesStepResponse(control::PlantLanes<P, K>& lanes,
+                                         const P& plant, double& checksum) {
+  auto scenarios = std::array<control::Scenario, K>();
+  lanes.reset(plant, scenarios, control::System::Timing());
+
+  using T = typename P::value_type;
+
+  auto input = control::simd::Broadcast(T(1.0));
+  auto outputs = std::array<T, K>();
+  for (std::size_t i = 0; i < control::PlantControl::kNumSamples; ++i) {
+    for (std::size_t j = 0; j < K; j += control::simd::Pack<T>::kWidth) {
+      control::simd::Store(
+          &outputs[j],
+          lanes.Step(j, input, control::simd::Load(&outputs[j])));
+    }
+    lanes.Advance();
+  }
+  checksum += outputs[0];
+
+  return K * control::PlantControl::kNumSamples;
+}
+
+// 1 / ((s + 1)(0.5 s + 1)) with one second of dead time, and 1 / (s + 1)^4.
+constexpr const auto kSecondOrder =
+    control::StateSpace<2>::FromTransferFunction({0.0, 0.0, 1.0},
+                                                 {0.5, 1.5, 1.0});
+constexpr const auto kFourthOrder =
+    control::StateSpace<4>::FromTransferFunction(
+        {0.0, 0.0, 0.0, 0.0, 1.0}, {1.0, 4.0, 6.0, 4.0, 1.0});
+constexpr const double kDeadTimeSecs = 1.0;
+
+}  // namespace
+
+int main() {
+  auto virtual_system = control::PlantControl();
+  auto static_system = control::StaticPlantControl<>();
+
+  std::size_t virtual_run = 0;
+  std::size_t static_run = 0;
+  double virtual_checksum = 0.0;
+  double static_checksum = 0.0;
+
+  bench::Report(bench::Run("system/virtual", [&]() {
+    return StepResponse(virtual_system, virtual_run, virtual_checksum);
+  }));
+  bench::Report(bench::Run("system/static", [&]() {
+    return StepResponse(static_system, static_run, static_checksum);
+  }));
+
+  // The plant updates alone: today's first order plant against state-space
+  // plants of increasing order, scalar and batched.
+  auto first_order = control::StaticPlant<>();
+  auto state_space_first_order = control::StateSpacePlant<1>(
+      control::StateSpace<1>::FromTransferFunction(
+          {0.0, 1.0}, {1.0, control::Plant::kEpsilon}));
+  auto second_order =
+      control::StateSpacePlant<2, 128>(kSecondOrder, kDeadTimeSecs);
+  auto fourth_order = control::StateSpacePlant<4>(kFourthOrder);
+
+  double plant_checksum = 0.0;
+  bench::Report(bench::Run("plant/first_order", [&]() {
+    return PlantStepResponse(first_order, plant_checksum);
+  }));
+  bench::Report(bench::Run("plant/state_space_first_order", [&]() {
+    return PlantStepResponse(state_space_first_order, plant_checksum);
+  }));
+  bench::Report(bench::Run("plant/state_space_second_order_dead_time", [&]() {
+    return PlantStepResponse(second_order, plant_checksum);
+  }));
+  bench::Report(bench::Run("plant/state_space_fourth_order", [&]() {
+    return PlantStepResponse(fourth_order, plant_checksum);
+  }));
+
+  auto first_order_lanes = control::PlantLanes<control::StaticPlant<>, 16>();
+  auto second_order_lanes =
+      control::PlantLanes<control::StateSpacePlant<2, 128>, 16>();
+  auto float_first_order = control::StaticPlant<float>(first_order);
+  auto float_second_order =
+      control::StateSpacePlant<2, 128, float>(second_order);
+  auto float_first_order_lanes =
+      control::PlantLanes<control::StaticPlant<float>, 16>();
+  auto float_second_order_lanes =
+      control::PlantLanes<control::StateSpacePlant<2, 128, float>, 16>();
+  bench::Report(bench::Run("plant/batch_first_order", [&]() {
+    return PlantLanesStepResponse(first_order_lanes, first_order,
+                                  plant_checksum);
+  }));
+  bench::Report(bench::Run("plant/batch_second_order_dead_time", [&]() {
+    return PlantLanesStepResponse(second_order_lanes, second_order,
+                                  plant_checksum);
+  }));
+  bench::Report(bench::Run("plant/batch_first_order_float", [&]() {
+    return PlantLanesStepResponse(float_first_order_lanes, float_first_order,
+                                  plant_checksum);
+  }));
+  bench::Report(bench::Run("plant/batch_second_order_dead_time_float", [&]() {
+    return PlantLanesStepResponse(float_second_order_lanes,
+                                  float_second_order, plant_checksum);
+  }));
+  bench::DoNotOptimize(plant_checksum);
+
+  // Both loops must simulate the same responses.
+  static_system.controller().params() = virtual_system.controller().params();
+  auto virtual_response = virtual_system.StepResponse(false);
+  auto static_response = static_system.StepResponse(false);
+  if (virtual_response.integral_squared_error !=
+      static_response.integral_squared_error) {
+    std::cerr << "Virtual and static responses differ" << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,82 @@
+#include <unistd.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "bench.h"
+#include "control/system.h"
+#include "control/trace.h"
+
+namespace {
+
+constexpr const std::size_t kNumSamples = 1000000;
+
+// A long, slowly settling trace.
+const control::System::Response LongResponse() {
+  auto response = control::System::Response();
+  response.time_values.reserve(kNumSamples);
+  for (std::size_t i = 0; i < kNumSamples; ++i) {
+    double time = i * control::System::kSampleTimeSecs;
+    response.time_values.push_back(control::System::Response::TimeValue(
+        time, 1.0 - std::exp(-time / 100.0) * std::cos(time)));
+  }
+
+  response.num_samples = kNumSamples;
+  response.rise_time = 1.0;
+  response.max_overshoot = 1.2;
+
+  return response;
+}
+
+}  // namespace
+
+int main() {
+  auto response = LongResponse();
+  auto prefix = "/tmp/trace_bench_" + std::to_string(::getpid());
+  auto csv_file_name = prefix + ".csv";
+  auto trace_file_name = prefix + ".trace";
+
+  bench::Report(bench::Run("trace/write_csv", [&]() {
+    control::System::WriteResponseToFile(csv_file_name, response);
+    return kNumSamples;
+  }));
+
+  bench::Report(bench::Run("trace/write_binary", [&]() {
+    control::WriteTrace(trace_file_name, response);
+    return kNumSamples;
+  }));
+
+  bench::Report(bench::Run("trace/read_csv", [&]() {
+    auto csv_file = std::ifstream(csv_file_name.c_str());
+    auto line = std::string();
+    std::getline(csv_file, line);
+
+    double sum = 0.0;
+    while (std::getline(csv_file, line)) {
+      sum += std::stod(line.substr(line.find(',') + 1));
+    }
+
+    bench::DoNotOptimize(sum);
+    return kNumSamples;
+  }));
+
+  bench::Report(bench::Run("trace/read_binary", [&]() {
+    auto trace = control::MappedTrace(trace_file_name);
+
+    double sum = 0.0;
+    for (std::size_t i = 0, size = trace.num_samples(); i < size; ++i) {
+      sum += trace.values()[i];
+    }
+
+    bench::DoNotOptimize(sum);
+    return kNumSamples;
+  }));
+
+  std::remove(csv_file_name.c_str());
+  std::remove(trace_file_name.c_str());
+
+  return 0;
+}
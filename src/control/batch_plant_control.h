@@ -0,0 +1,391 @@
+#ifndef CONTROL_BATCH_PLANT_CONTROL_H_
+#define CONTROL_BATCH_PLANT_CONTROL_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "control/controller.h"
+#include "control/plant.h"
+#include "control/plant_control.h"
+#include "control/scenario.h"
+#include "control/simd.h"
+#include "control/state_space_plant.h"
+#include "control/system.h"
+
+namespace control {
+
+// The plant side of BatchPlantControl: K copies of the plant P, one per lane,
+// kept as structure-of-arrays. `reset` loads them for a batch of scenarios,
+// `Step(i, input, measurement)` advances the lanes
+// [i, i + simd::Pack<T>::kWidth) by one sample and returns their outputs, and
+// `Advance` ends the sample.
+template <typename P, std::size_t K>
+class PlantLanes;
+
+template <typename T, std::size_t K>
+class PlantLanes<StaticPlant<T>, K> {
+ public:
+  // The constants are computed with the same expressions Plant::Model
+  // evaluates every sample, so they round identically. The pole comes from
+  // the scenarios rather than from `plant`.
+  constexpr void reset(const StaticPlant<T>&,
+                       const std::array<Scenario, K>& scenarios,
+                       const System::Timing& timing) {
+    sample_time_ = timing.sample_time;
+    for (std::size_t lane = 0; lane < K; ++lane) {
+      denominator_[lane] =
+          T(1.0) + (T(scenarios[lane].plant_epsilon) * sample_time_);
+    }
+  }
+
+  const simd::Pack<T> Step(const std::size_t i, const simd::Pack<T>& input,
+                           const simd::Pack<T>& measurement) const {
+    return ((simd::Broadcast(sample_time_) * input) + measurement) /
+           simd::Load(&denominator_[i]);
+  }
+
+  constexpr void Advance() {}
+
+ private:
+  T sample_time_;
+  alignas(64) std::array<T, K> denominator_;
+};
+
+// Every lane shares the model and dead time of `plant`, so the delay line
+// advances in step for all of them.
+template <std::size_t Order, std::size_t MaxDelay, typename T, std::size_t K>
+class PlantLanes<StateSpacePlant<Order, MaxDelay, T>, K> {
+ public:
+  using P = StateSpacePlant<Order, MaxDelay, T>;
+
+  constexpr void reset(const P& plant, const std::array<Scenario, K>&,
+                       const System::Timing& timing) {
+    model_ = plant.model().Discretize(timing.sample_time).template Cast<T>();
+    delay_ = P::DelaySamples(plant.dead_time(), timing.sample_time);
+    delay_head_ = 0;
+    for (auto& state : state_) {
+      state.fill(0.0);
+    }
+    if constexpr (MaxDelay != 0) {
+      for (std::size_t j = 0; j < delay_; ++j) {
+        delay_line_[j].fill(0.0);
+      }
+    }
+  }
+
+  const simd::Pack<T> Step(const std::size_t i, const simd::Pack<T>& input,
+                           const simd::Pack<T>&) {
+    auto delayed = input;
+    if constexpr (MaxDelay != 0) {
+      if (delay_ != 0) {
+        delayed = simd::Load(&delay_line_[delay_head_][i]);
+        simd::Store(&delay_line_[delay_head_][i], input);
+      }
+    }
+
+    auto state = std::array<simd::Pack<T>, Order>();
+    for (std::size_t j = 0; j < Order; ++j) {
+      state[j] = simd::Load(&state_[j][i]);
+    }
+
+    auto output = P::Update(model_, state, delayed, [](const T value) {
+      return simd::Broadcast(value);
+    });
+
+    for (std::size_t j = 0; j < Order; ++j) {
+      simd::Store(&state_[j][i], state[j]);
+    }
+
+    return output;
+  }
+
+  constexpr void Advance() {
+    if (delay_ != 0 && ++delay_head_ == delay_) {
+      delay_head_ = 0;
+    }
+  }
+
+ private:
+  typename P::DiscreteModel model_;
+  std::size_t delay_;
+  std::size_t delay_head_;
+
+  alignas(64) std::array<std::array<T, K>, Order> state_;
+  alignas(64) std::array<std::array<T, K>, MaxDelay> delay_line_;
+};
+
+// Simulates the step response of up to K controller parameter sets, each in
+// its own Scenario, in lockstep on copies of the plant P. State is kept as
+// structure-of-arrays so that every sample updates simd::Pack<T>::kWidth
+// lanes per instruction, where T is the plant's scalar type. Each lane follows
+// exactly the same arithmetic as PlantControl, so its metrics match the scalar
+// simulation in the same type.
+template <std::size_t K, typename P = StaticPlant<>>
+class BatchPlantControl {
+ public:
+  using T = typename P::value_type;
+
+  static_assert(K % simd::Pack<T>::kWidth == 0,
+                "Batch size must be a multiple of the SIMD width");
+
+  using Response = System::BasicResponse<T>;
+  using Timing = System::Timing;
+
+  static constexpr const std::size_t kNumLanes = K;
+
+  constexpr BatchPlantControl() = default;
+  constexpr ~BatchPlantControl() = default;
+
+  constexpr const std::array<Controller::Parameters, K>& params() const {
+    return params_;
+  }
+  constexpr std::array<Controller::Parameters, K>& params() { return params_; }
+
+  constexpr const std::array<Scenario, K>& scenarios() const {
+    return scenarios_;
+  }
+  constexpr std::array<Scenario, K>& scenarios() { return scenarios_; }
+
+  // The plant every lane simulates, apart from the disturbance and, for
+  // StaticPlant, the pole its scenario sets.
+  constexpr const P& plant() const { return plant_; }
+  constexpr P& plant() { return plant_; }
+
+  constexpr const Timing& timing() const { return timing_; }
+  constexpr void set_timing(const Timing& timing) { timing_ = timing; }
+
+  // Simulates the first `num_lanes` parameter sets. Every `abort_interval`
+  // samples `abort(lane, response, time)` is consulted for each lane still
+  // running; returning true freezes that lane's response and marks it as
+  // aborted. The simulation stops once every lane has finished.
+  template <typename Abort>
+  const std::array<Response, K> StepResponse(
+      const std::size_t num_lanes, Abort&& abort,
+      const std::size_t abort_interval = 1) {
+    auto responses = std::array<Response, K>();
+
+    reset();
+
+    std::uint64_t running = 0;
+    for (std::size_t lane = 0; lane < num_lanes && lane < K; ++lane) {
+      running |= std::uint64_t(1) << lane;
+    }
+
+    std::size_t num_samples = 0;
+    double prev_time = 0.0;
+    for (double time = 0.0;
+         running != 0 && time <= timing_.simulation_time;
+         time += timing_.sample_time) {
+      for (std::size_t i = 0; i < K; i += simd::Pack<T>::kWidth) {
+        Step(i, time, time - prev_time);
+      }
+      plant_lanes_.Advance();
+
+      prev_time = time;
+      ++num_samples;
+
+      if (abort_interval != 0 && num_samples % abort_interval == 0) {
+        for (std::size_t lane = 0; lane < K; ++lane) {
+          if (running & (std::uint64_t(1) << lane)) {
+            auto response = LaneResponse(lane, num_samples);
+            if (abort(lane, response, time)) {
+              response.aborted = true;
+              responses[lane] = response;
+              running &= ~(std::uint64_t(1) << lane);
+            }
+          }
+        }
+      }
+    }
+
+    for (std::size_t lane = 0; lane < K; ++lane) {
+      if (running & (std::uint64_t(1) << lane)) {
+        responses[lane] = LaneResponse(lane, num_samples);
+      }
+    }
+
+    return responses;
+  }
+
+ private:
+  static constexpr const T kInfinity = std::numeric_limits<T>::infinity();
+
+  static_assert(K <= 64, "Batch size must fit the running lane bit set");
+
+  // Loads the per-lane constants and clears the simulation state. The
+  // constants are computed with the same expressions Controller::ControlLaw
+  // evaluates every sample, so they round identically.
+  constexpr void reset() {
+    const T sample_time = timing_.sample_time;
+
+    plant_lanes_.reset(plant_, scenarios_, timing_);
+    for (std::size_t lane = 0; lane < K; ++lane) {
+      const auto& params = params_[lane];
+      const auto& scenario = scenarios_[lane];
+
+      setpoint_[lane] = T(scenario.setpoint);
+      load_[lane] = T(scenario.disturbance.load);
+      load_time_[lane] = T(scenario.disturbance.time);
+
+      k_p_[lane] = T(params.k_p);
+      integral_gain_[lane] = T(0.5) * T(params.k_i()) * sample_time;
+      derivative_gain_[lane] = T(2.0) * T(params.k_d());
+      derivative_decay_[lane] = T(2.0) * T(params.tau) - sample_time;
+      derivative_scale_[lane] = T(2.0) * T(params.tau) + sample_time;
+
+      integrator_[lane] = 0.0;
+      differentiator_[lane] = 0.0;
+      prev_error_[lane] = 0.0;
+      prev_measurement_[lane] = 0.0;
+      output_[lane] = 0.0;
+
+      integral_squared_error_[lane] = 0.0;
+      rise_time_[lane] = kInfinity;
+      settling_time_[lane] = kInfinity;
+      max_overshoot_[lane] = -kInfinity;
+    }
+  }
+
+  // Advances the lanes [i, i + simd::Pack<T>::kWidth) by one sample.
+  void Step(const std::size_t i, const double time, const double dt) {
+    using simd::Broadcast;
+    using simd::Load;
+    using simd::Select;
+    using simd::Store;
+
+    const auto zero = Broadcast(T(0.0));
+    const auto one = Broadcast(T(Controller::kUnitStepSetPoint));
+    const auto setpoint = Load(&setpoint_[i]);
+    const auto now = Broadcast(T(time));
+    const auto output_min = Broadcast(T(Controller::kOutputMin));
+    const auto output_max = Broadcast(T(Controller::kOutputMax));
+
+    // Controller
+    auto measurement = Load(&output_[i]);
+    auto error = setpoint - measurement;
+
+    auto proportional = Load(&k_p_[i]) * error;
+
+    auto integrator = Load(&integrator_[i]) +
+                      Load(&integral_gain_[i]) * (error + Load(&prev_error_[i]));
+
+    auto integrator_min = Select(output_min < proportional,
+                                 output_min - proportional, zero);
+    auto integrator_max = Select(output_max > proportional,
+                                 output_max - proportional, zero);
+
+    integrator = Select(integrator < integrator_min, integrator_min,
+                        Select(integrator > integrator_max, integrator_max,
+                               integrator));
+
+    auto differentiator =
+        -((Load(&derivative_gain_[i]) *
+           (measurement - Load(&prev_measurement_[i]))) +
+          (Load(&derivative_decay_[i]) * Load(&differentiator_[i]))) /
+        Load(&derivative_scale_[i]);
+
+    auto control = proportional + integrator + differentiator;
+    control = Select(control < output_min, output_min,
+                     Select(control > output_max, output_max, control));
+
+    Store(&integrator_[i], integrator);
+    Store(&differentiator_[i], differentiator);
+    Store(&prev_error_[i], error);
+    Store(&prev_measurement_[i], measurement);
+
+    // Plant
+    auto input = control + Select(now >= Load(&load_time_[i]),
+                                  Load(&load_[i]), zero);
+    measurement = plant_lanes_.Step(i, input, measurement);
+    Store(&output_[i], measurement);
+
+    // Metrics relative to the setpoint, see PlantControl::Simulate. A rise,
+    // settling or overshoot that has not happened yet is encoded as an
+    // infinity.
+    auto level = measurement / setpoint;
+    error = one - level;
+    Store(&integral_squared_error_[i], Load(&integral_squared_error_[i]) +
+                                           (error * error) * Broadcast(T(dt)));
+
+    // std::round(level * 100.0) / 100.0 == kRiseTimeThreshold
+    auto percent = level * Broadcast(T(100.0));
+    auto rise_time = Load(&rise_time_[i]);
+    Store(&rise_time_[i],
+          Select((percent >= Broadcast(T(kRiseTimePercentMin))) &
+                     (Broadcast(T(kRiseTimePercentMax)) > percent) &
+                     (rise_time > now),
+                 now, rise_time));
+
+    auto abs_error = simd::Abs(error);
+    auto threshold = Broadcast(T(PlantControl::kSteadyStateThreshold));
+    auto settling_time = Load(&settling_time_[i]);
+    Store(&settling_time_[i],
+          Select(abs_error > threshold, Broadcast(kInfinity),
+                 Select((threshold > abs_error) & (settling_time > now), now,
+                        settling_time)));
+
+    auto max_overshoot = Load(&max_overshoot_[i]);
+    Store(&max_overshoot_[i],
+          Select((level >= one) & (level > max_overshoot), level,
+                 max_overshoot));
+  }
+
+  const Response LaneResponse(const std::size_t lane,
+                              const std::size_t num_samples) const {
+    auto response = Response();
+    response.num_samples = num_samples;
+    response.integral_squared_error = integral_squared_error_[lane];
+    if (rise_time_[lane] != kInfinity) {
+      response.rise_time = rise_time_[lane];
+    }
+    if (settling_time_[lane] != kInfinity) {
+      response.settling_time = settling_time_[lane];
+    }
+    if (max_overshoot_[lane] != -kInfinity) {
+      response.max_overshoot = max_overshoot_[lane];
+    }
+
+    return response;
+  }
+
+  // std::round(x) == 90 exactly when 89.5 <= x < 90.5.
+  static constexpr const double kRiseTimePercentMin =
+      PlantControl::kRiseTimeThreshold * 100.0 - 0.5;
+  static constexpr const double kRiseTimePercentMax =
+      PlantControl::kRiseTimeThreshold * 100.0 + 0.5;
+
+  static_assert(kRiseTimePercentMin == 89.5 && kRiseTimePercentMax == 90.5);
+
+  std::array<Controller::Parameters, K> params_;
+  std::array<Scenario, K> scenarios_;
+  Timing timing_;
+  P plant_;
+  PlantLanes<P, K> plant_lanes_;
+
+  alignas(64) std::array<T, K> setpoint_;
+  alignas(64) std::array<T, K> load_;
+  alignas(64) std::array<T, K> load_time_;
+
+  alignas(64) std::array<T, K> k_p_;
+  alignas(64) std::array<T, K> integral_gain_;
+  alignas(64) std::array<T, K> derivative_gain_;
+  alignas(64) std::array<T, K> derivative_decay_;
+  alignas(64) std::array<T, K> derivative_scale_;
+
+  alignas(64) std::array<T, K> integrator_;
+  alignas(64) std::array<T, K> differentiator_;
+  alignas(64) std::array<T, K> prev_error_;
+  alignas(64) std::array<T, K> prev_measurement_;
+  alignas(64) std::array<T, K> output_;
+
+  alignas(64) std::array<T, K> integral_squared_error_;
+  alignas(64) std::array<T, K> rise_time_;
+  alignas(64) std::array<T, K> settling_time_;
+  alignas(64) std::array<T, K> max_overshoot_;
+};
+
+}  // namespace control
+
+#endif  // CONTROL_BATCH_PLANT_CONTROL_H_
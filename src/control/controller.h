@@ -3,6 +3,7 @@
 
 #include <cstddef>
 
+#include "control/static_system.h"
 #include "control/system.h"
 
 namespace control {
@@ -32,6 +33,17 @@ class Controller : public System {
     double tau;
   };
 
+  template <typename T = double>
+  struct State {
+    constexpr State() = default;
+    constexpr ~State() = default;
+
+    T integrator = 0.0;
+    T differentiator = 0.0;
+    T prev_error = 0.0;
+    T prev_measurement = 0.0;
+  };
+
   static constexpr const int kNumParams = 3;
 
   static constexpr const double kOutputMin = -10.0;
@@ -43,66 +55,116 @@ class Controller : public System {
       : System(), setpoint_(setpoint) {}
 
   constexpr Controller(const double k_p, const double t_i, const double t_d)
-      : System(), params_(k_p, t_i, t_d) {}
+      : System(), params_(k_p, t_i, t_d), setpoint_(kUnitStepSetPoint) {}
 
   virtual constexpr ~Controller() = default;
 
   constexpr const Parameters& params() const { return params_; }
   constexpr Parameters& params() { return params_; }
 
+  constexpr const double setpoint() const { return setpoint_; }
+  constexpr double& setpoint() { return setpoint_; }
+
   constexpr void reset() override {
     System::reset();
-    integrator_ = 0.0;
-    differentiator_ = 0.0;
-    prev_error_ = 0.0;
-    prev_measurement_ = 0.0;
+    state_ = State<>();
+  }
+
+  // The discrete PID law, shared by Controller and StaticController. Every
+  // operation is carried out in T, with the parameters rounded to T first.
+  template <typename T>
+  static constexpr const T ControlLaw(const Parameters& params,
+                                      const T setpoint, State<T>& state,
+                                      const T measurement,
+                                      const double sample_time) {
+    const T output_min = kOutputMin;
+    const T output_max = kOutputMax;
+
+    T error = setpoint - measurement;
+
+    T proportional = T(params.k_p) * error;
+
+    state.integrator = state.integrator + T(0.5) * T(params.k_i()) *
+                                              T(sample_time) *
+                                              (error + state.prev_error);
+
+    T integrator_min =
+        output_min < proportional ? output_min - proportional : T(0.0);
+    T integrator_max =
+        output_max > proportional ? output_max - proportional : T(0.0);
+
+    if (state.integrator < integrator_min) {
+      state.integrator = integrator_min;
+    } else if (state.integrator > integrator_max) {
+      state.integrator = integrator_max;
+    }
+
+    state.differentiator =
+        -((T(2.0) * T(params.k_d()) * (measurement - state.prev_measurement)) +
+          ((T(2.0) * T(params.tau) - T(sample_time)) * state.differentiator)) /
+        (T(2.0) * T(params.tau) + T(sample_time));
+
+    T output = proportional + state.integrator + state.differentiator;
+    if (output < output_min) {
+      output = output_min;
+    } else if (output > output_max) {
+      output = output_max;
+    }
+
+    state.prev_error = error;
+    state.prev_measurement = measurement;
+
+    return output;
   }
 
  protected:
   constexpr const double Transform(const double measurement) override {
-    double error = setpoint_ - measurement;
+    return ControlLaw(params_, setpoint_, state_, measurement, sample_time());
+  }
 
-    double proportional = params_.k_p * error;
+  Parameters params_;
 
-    integrator_ = integrator_ +
-                  0.5 * params_.k_i() * kSampleTimeSecs * (error + prev_error_);
+  double setpoint_;
+  State<> state_;
+};
 
-    double integrator_min =
-        kOutputMin < proportional ? kOutputMin - proportional : 0.0;
-    double integrator_max =
-        kOutputMax > proportional ? kOutputMax - proportional : 0.0;
+// Controller without virtual dispatch, for composition in StaticPlantControl,
+// simulated in the scalar type T.
+template <typename T = double>
+class StaticController : public StaticSystem<StaticController<T>, T> {
+ public:
+  using Parameters = Controller::Parameters;
+  using State = Controller::State<T>;
 
-    if (integrator_ < integrator_min) {
-      integrator_ = integrator_min;
-    } else if (integrator_ > integrator_max) {
-      integrator_ = integrator_max;
-    }
+  constexpr StaticController(
+      const double setpoint = Controller::kUnitStepSetPoint)
+      : StaticSystem<StaticController<T>, T>(), setpoint_(setpoint) {}
 
-    differentiator_ =
-        -((2.0 * params_.k_d() * (measurement - prev_measurement_)) +
-          ((2.0 * params_.tau - kSampleTimeSecs) * differentiator_)) /
-        (2.0 * params_.tau + kSampleTimeSecs);
+  constexpr ~StaticController() = default;
 
-    double output = proportional + integrator_ + differentiator_;
-    if (output < kOutputMin) {
-      output = kOutputMin;
-    } else if (output > kOutputMax) {
-      output = kOutputMax;
-    }
+  constexpr const Parameters& params() const { return params_; }
+  constexpr Parameters& params() { return params_; }
 
-    prev_error_ = error;
-    prev_measurement_ = measurement;
+  constexpr const double setpoint() const { return setpoint_; }
+  constexpr double& setpoint() { return setpoint_; }
 
-    return output;
+  constexpr void reset() {
+    StaticSystem<StaticController<T>, T>::reset();
+    state_ = State();
+  }
+
+ private:
+  friend class StaticSystem<StaticController<T>, T>;
+
+  constexpr const T Transform(const T measurement) {
+    return Controller::ControlLaw(params_, T(setpoint_), state_, measurement,
+                                  this->sample_time());
   }
 
   Parameters params_;
 
   double setpoint_;
-  double integrator_;
-  double differentiator_;
-  double prev_error_;
-  double prev_measurement_;
+  State state_;
 };
 
 }  // namespace control
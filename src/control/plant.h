@@ -1,6 +1,7 @@
 #ifndef CONTROL_PLANT_H_
 #define CONTROL_PLANT_H_
 
+#include "control/static_system.h"
 #include "control/system.h"
 
 namespace control {
@@ -9,16 +10,114 @@ class Plant : public System {
  public:
   static constexpr const double kEpsilon = 0.02;
 
-  constexpr Plant() = default;
+  // A constant load added to the plant input from `time` on.
+  struct Disturbance {
+    constexpr Disturbance(const double load = 0.0, const double time = 0.0)
+        : load(load), time(time) {}
+
+    constexpr ~Disturbance() = default;
+
+    // The load at `elapsed` seconds into a simulation, decided and given in
+    // the scalar type T so that batched simulations can match it.
+    template <typename T = double>
+    constexpr const T at(const double elapsed) const {
+      return T(elapsed) >= T(time) ? T(load) : T(0.0);
+    }
+
+    double load;
+    double time;
+  };
+
+  constexpr Plant(const double epsilon = kEpsilon)
+      : System(), epsilon_(epsilon), elapsed_(0.0) {}
+
   virtual constexpr ~Plant() = default;
 
-  constexpr void reset() final { System::reset(); }
+  constexpr const double epsilon() const { return epsilon_; }
+  constexpr double& epsilon() { return epsilon_; }
+
+  constexpr const Disturbance& disturbance() const { return disturbance_; }
+  constexpr Disturbance& disturbance() { return disturbance_; }
+
+  constexpr void reset() final {
+    System::reset();
+    elapsed_ = 0.0;
+  }
+
+  // The backward Euler first order model, shared by Plant and StaticPlant,
+  // carried out in T.
+  template <typename T>
+  static constexpr const T Model(const T output, const T input,
+                                 const double sample_time,
+                                 const double epsilon) {
+    return ((T(sample_time) * input) + output) /
+           (T(1.0) + (T(epsilon) * T(sample_time)));
+  }
 
  protected:
   constexpr const double Transform(const double input) final {
-    return ((kSampleTimeSecs * input) + output()) /
-           (1.0 + (kEpsilon * kSampleTimeSecs));
+    auto output = Model(this->output(), input + disturbance_.at(elapsed_),
+                        sample_time(), epsilon_);
+    elapsed_ += sample_time();
+
+    return output;
   }
+
+ private:
+  double epsilon_;
+  Disturbance disturbance_;
+  double elapsed_;
+};
+
+// Plant without virtual dispatch, for composition in StaticPlantControl,
+// simulated in the scalar type T.
+template <typename T = double>
+class StaticPlant : public StaticSystem<StaticPlant<T>, T> {
+ public:
+  using Disturbance = Plant::Disturbance;
+
+  // The same plant simulated in another scalar type.
+  template <typename U>
+  using Rebind = StaticPlant<U>;
+
+  constexpr StaticPlant(const double epsilon = Plant::kEpsilon)
+      : StaticSystem<StaticPlant<T>, T>(), epsilon_(epsilon), elapsed_(0.0) {}
+
+  // Copies the configuration of `plant`, but not its state.
+  template <typename U>
+  constexpr explicit StaticPlant(const StaticPlant<U>& plant)
+      : StaticPlant(plant.epsilon()) {
+    disturbance_ = plant.disturbance();
+  }
+
+  constexpr ~StaticPlant() = default;
+
+  constexpr const double epsilon() const { return epsilon_; }
+  constexpr double& epsilon() { return epsilon_; }
+
+  constexpr const Disturbance& disturbance() const { return disturbance_; }
+  constexpr Disturbance& disturbance() { return disturbance_; }
+
+  constexpr void reset() {
+    StaticSystem<StaticPlant<T>, T>::reset();
+    elapsed_ = 0.0;
+  }
+
+ private:
+  friend class StaticSystem<StaticPlant<T>, T>;
+
+  constexpr const T Transform(const T input) {
+    auto output =
+        Plant::Model(this->output(), input + disturbance_.at<T>(elapsed_),
+                     this->sample_time(), epsilon_);
+    elapsed_ += this->sample_time();
+
+    return output;
+  }
+
+  double epsilon_;
+  Disturbance disturbance_;
+  double elapsed_;
 };
 
 }  // namespace control
@@ -5,9 +5,11 @@
 #include <cmath>
 #include <cstddef>
 #include <limits>
+#include <type_traits>
 
 #include "control/controller.h"
 #include "control/plant.h"
+#include "control/static_system.h"
 #include "control/system.h"
 
 namespace control {
@@ -20,6 +22,9 @@ class PlantControl : public System {
   static constexpr const double kSteadyStateThreshold =
       Controller::kUnitStepSetPoint * kSteadyStateErrorPercent;
 
+  // The number of samples of a simulation with the default timing.
+  static constexpr const std::size_t kNumSamples = Timing().num_samples();
+
   constexpr PlantControl() = default;
   virtual constexpr ~PlantControl() = default;
 
@@ -35,41 +40,102 @@ class PlantControl : public System {
     plant_.reset();
   }
 
-  const Response StepResponse() {
-    reset();
+  // Applies to the controller and the plant too.
+  constexpr void set_timing(const Timing& timing) final {
+    System::set_timing(timing);
+    controller_.set_timing(timing);
+    plant_.set_timing(timing);
+  }
+
+  const Response StepResponse(const bool record_time_values = true) {
+    return StepResponse(record_time_values,
+                        [](const Response&, const double) { return false; });
+  }
+
+  // Simulates a unit step and computes its metrics in a single pass. The
+  // time/value trace is only kept when `record_time_values` is set, so the
+  // metrics-only mode performs no heap allocation. `abort(response, time)` is
+  // consulted after every sample; returning true stops the simulation early
+  // and marks the response as aborted.
+  template <typename Abort>
+  const Response StepResponse(const bool record_time_values, Abort&& abort) {
+    return Simulate(*this, record_time_values, abort);
+  }
+
+  // The closed loop step simulation behind StepResponse, for any system with
+  // `reset()`, `timing()`, `controller().setpoint()` and
+  // `update_output(input)` whose output is fed back as its next input. The
+  // trace holds the plant output, while the metrics are taken relative to the
+  // setpoint, so they compare across setpoints. Signals and metrics are
+  // computed in the system's value_type; the clock always runs in double.
+  template <typename S, typename Abort>
+  static const System::BasicResponse<typename S::value_type> Simulate(
+      S& system, const bool record_time_values, Abort&& abort) {
+    using T = typename S::value_type;
+    using Response = System::BasicResponse<T>;
+
+    const T one = Controller::kUnitStepSetPoint;
+    const T rise_time_threshold = kRiseTimeThreshold;
+    const T steady_state_threshold = kSteadyStateThreshold;
+
+    system.reset();
+
+    const auto timing = system.timing();
+    const auto setpoint = T(system.controller().setpoint());
 
     auto response = Response();
+    if (record_time_values) {
+      response.time_values.reserve(timing.num_samples());
+    }
+
+    T measurement = 0.0;
+    double prev_time = 0.0;
+    for (double time = 0.0; time <= timing.simulation_time;
+         time += timing.sample_time) {
+      measurement = system.update_output(measurement);
+      ++response.num_samples;
+      if (record_time_values) {
+        response.time_values.push_back(
+            typename Response::TimeValue(T(time), measurement));
+      }
 
-    for (double time = 0.0; time <= kSimulationTimeSecs;
-         time += kSampleTimeSecs) {
-      double measurement = update_output(output());
-      response.time_values.push_back(Response::TimeValue(time, measurement));
+      T level = measurement / setpoint;
+      T error = one - level;
+      response.integral_squared_error +=
+          (error * error) * T(time - prev_time);
+      prev_time = time;
 
       if (!response.rise_time.has_value() &&
-          std::round(measurement * 100.0) / 100.0 == kRiseTimeThreshold) {
-        response.rise_time = time;
+          std::round(level * T(100.0)) / T(100.0) == rise_time_threshold) {
+        response.rise_time = T(time);
       }
 
-      double abs_error = std::fabs(Controller::kUnitStepSetPoint - measurement);
+      T abs_error = std::fabs(error);
       if (!response.settling_time.has_value() &&
-          abs_error < kSteadyStateThreshold) {
-        response.settling_time = time;
+          abs_error < steady_state_threshold) {
+        response.settling_time = T(time);
       } else if (response.settling_time.has_value() &&
-                 abs_error > kSteadyStateThreshold) {
+                 abs_error > steady_state_threshold) {
         response.settling_time.reset();
       }
 
-      if (measurement >= Controller::kUnitStepSetPoint) {
+      if (level >= one) {
         response.max_overshoot =
             response.max_overshoot.has_value()
-                ? std::max(response.max_overshoot.value(), measurement)
-                : measurement;
+                ? std::max(response.max_overshoot.value(), level)
+                : level;
+      }
+
+      if (abort(response, time)) {
+        response.aborted = true;
+        break;
       }
     }
 
     return response;
   }
 
+  // Recomputes the integral squared error from a recorded trace.
   static constexpr const double IntegralSquaredError(const Response& response) {
     auto& time_values = response.time_values;
     double ise = 0.0;
@@ -91,6 +157,64 @@ class PlantControl : public System {
   Plant plant_;
 };
 
+// Closed loop composed at compile time. Every block is called without virtual
+// dispatch, so the whole simulation loop can be inlined. PlantControl remains
+// the runtime-polymorphic equivalent. The controller and the plant must share
+// their scalar type, which the loop is simulated in.
+template <typename C = StaticController<>, typename P = StaticPlant<>>
+class StaticPlantControl
+    : public StaticSystem<StaticPlantControl<C, P>, typename P::value_type> {
+ public:
+  using T = typename P::value_type;
+  using Response = System::BasicResponse<T>;
+
+  static_assert(std::is_same_v<typename C::value_type, T>,
+                "Controller and plant must share their scalar type");
+
+  constexpr StaticPlantControl() = default;
+  constexpr ~StaticPlantControl() = default;
+
+  constexpr const C& controller() const { return controller_; }
+  constexpr C& controller() { return controller_; }
+
+  constexpr const P& plant() const { return plant_; }
+  constexpr P& plant() { return plant_; }
+
+  constexpr void reset() {
+    StaticSystem<StaticPlantControl<C, P>, T>::reset();
+    controller_.reset();
+    plant_.reset();
+  }
+
+  // See PlantControl::set_timing.
+  constexpr void set_timing(const System::Timing& timing) {
+    StaticSystem<StaticPlantControl<C, P>, T>::set_timing(timing);
+    controller_.set_timing(timing);
+    plant_.set_timing(timing);
+  }
+
+  const Response StepResponse(const bool record_time_values = true) {
+    return StepResponse(record_time_values,
+                        [](const Response&, const double) { return false; });
+  }
+
+  // See PlantControl::StepResponse.
+  template <typename Abort>
+  const Response StepResponse(const bool record_time_values, Abort&& abort) {
+    return PlantControl::Simulate(*this, record_time_values, abort);
+  }
+
+ private:
+  friend class StaticSystem<StaticPlantControl<C, P>, T>;
+
+  constexpr const T Transform(const T input) {
+    return plant_.update_output(controller_.update_output(input));
+  }
+
+  C controller_;
+  P plant_;
+};
+
 }  // namespace control
 
 #endif  // CONTROL_PLANT_CONTROL_SYSTEM_H_
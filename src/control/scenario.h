@@ -0,0 +1,144 @@
+#ifndef CONTROL_SCENARIO_H_
+#define CONTROL_SCENARIO_H_
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "control/controller.h"
+#include "control/plant.h"
+
+namespace control {
+
+// One operating condition a controller is tuned for: a step to `setpoint` on
+// a plant with pole `plant_epsilon`, optionally under a load disturbance.
+// `weight` only counts for Aggregate::kWeighted. The default is the nominal
+// unit step.
+struct Scenario {
+  constexpr Scenario(const double setpoint = Controller::kUnitStepSetPoint,
+                     const double plant_epsilon = Plant::kEpsilon,
+                     const Plant::Disturbance& disturbance =
+                         Plant::Disturbance(),
+                     const double weight = 1.0)
+      : setpoint(setpoint),
+        plant_epsilon(plant_epsilon),
+        disturbance(disturbance),
+        weight(weight) {}
+
+  constexpr ~Scenario() = default;
+
+  // Sets up a PlantControl or StaticPlantControl for this scenario. The pole
+  // only applies to first order plants.
+  template <typename S>
+  constexpr void Apply(S& plant_control) const {
+    plant_control.controller().setpoint() = setpoint;
+    if constexpr (requires { plant_control.plant().epsilon() = 0.0; }) {
+      plant_control.plant().epsilon() = plant_epsilon;
+    }
+    plant_control.plant().disturbance() = disturbance;
+  }
+
+  double setpoint;
+  double plant_epsilon;
+  Plant::Disturbance disturbance;
+  double weight;
+};
+
+// How the fitnesses of a chromosome over its scenarios combine.
+enum class Aggregate { kMean, kWorst, kWeighted };
+
+// Combines the fitnesses of `scenarios`. Every aggregate only grows with its
+// fitnesses, so combining lower bounds of them gives a lower bound of the
+// aggregate.
+inline const double AggregateFitness(const Aggregate aggregate,
+                                     const std::vector<Scenario>& scenarios,
+                                     const double* fitnesses) {
+  auto size = scenarios.size();
+  double result = 0.0;
+  double sum_of_weights = 0.0;
+  switch (aggregate) {
+    case Aggregate::kMean:
+      for (std::size_t i = 0; i < size; ++i) {
+        result += fitnesses[i];
+      }
+      return result / size;
+    case Aggregate::kWorst:
+      result = -std::numeric_limits<double>::infinity();
+      for (std::size_t i = 0; i < size; ++i) {
+        result = std::max(result, fitnesses[i]);
+      }
+      return result;
+    case Aggregate::kWeighted:
+      for (std::size_t i = 0; i < size; ++i) {
+        result += scenarios[i].weight * fitnesses[i];
+        sum_of_weights += scenarios[i].weight;
+      }
+      return result / sum_of_weights;
+  }
+
+  return result;
+}
+
+// Reads one scenario per line as "setpoint [plant_epsilon [load [load_time
+// [weight]]]]", with omitted fields taking their defaults. Blank lines and
+// lines starting with '#' are skipped. A file without scenarios is an error.
+inline const std::vector<Scenario> ReadScenarios(const std::string& file_name) {
+  auto file = std::ifstream(file_name.c_str(), std::fstream::in);
+  if (!file) {
+    throw std::system_error(errno, std::generic_category(), file_name);
+  }
+
+  auto scenarios = std::vector<Scenario>();
+  auto line = std::string();
+  for (std::size_t line_number = 1; std::getline(file, line); ++line_number) {
+    auto first = line.find_first_not_of(" \t");
+    if (first == std::string::npos || line[first] == '#') {
+      continue;
+    }
+
+    auto fields = std::istringstream(line);
+    auto values = std::vector<double>();
+    for (double value; fields >> value;) {
+      values.push_back(value);
+    }
+
+    if (!fields.eof() || values.empty() || values.size() > 5 ||
+        values[0] == 0.0) {
+      throw std::runtime_error(file_name + ":" + std::to_string(line_number) +
+                               ": malformed scenario");
+    }
+
+    auto scenario = Scenario(values[0]);
+    if (values.size() > 1) {
+      scenario.plant_epsilon = values[1];
+    }
+    if (values.size() > 2) {
+      scenario.disturbance.load = values[2];
+    }
+    if (values.size() > 3) {
+      scenario.disturbance.time = values[3];
+    }
+    if (values.size() > 4) {
+      scenario.weight = values[4];
+    }
+
+    scenarios.push_back(scenario);
+  }
+
+  if (scenarios.empty()) {
+    throw std::runtime_error(file_name + ": no scenarios");
+  }
+
+  return scenarios;
+}
+
+}  // namespace control
+
+#endif  // CONTROL_SCENARIO_H_
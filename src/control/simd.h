@@ -0,0 +1,386 @@
+#ifndef CONTROL_SIMD_H_
+#define CONTROL_SIMD_H_
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX512F__) || defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+namespace control::simd {
+
+// Packs of doubles or floats processed in lockstep, sized for the widest
+// instruction set enabled at compile time (AVX-512, AVX/AVX2 or plain scalar
+// code). A float pack holds twice the lanes of a double pack. Every operation
+// rounds exactly like its scalar counterpart, so kernels written against Pack
+// produce the same results on every target.
+template <typename T>
+struct Pack;
+
+// The result of comparing two Pack<T>.
+template <typename T>
+struct Mask;
+
+#if defined(__AVX512F__)
+
+template <>
+struct Mask<double> {
+  __mmask8 v;
+};
+
+template <>
+struct Pack<double> {
+  static constexpr const std::size_t kWidth = 8;
+
+  __m512d v;
+};
+
+inline Pack<double> Broadcast(const double value) {
+  return {_mm512_set1_pd(value)};
+}
+inline Pack<double> Load(const double* src) { return {_mm512_loadu_pd(src)}; }
+inline void Store(double* dst, const Pack<double>& p) {
+  _mm512_storeu_pd(dst, p.v);
+}
+
+inline Pack<double> operator+(const Pack<double>& a, const Pack<double>& b) {
+  return {_mm512_add_pd(a.v, b.v)};
+}
+inline Pack<double> operator-(const Pack<double>& a, const Pack<double>& b) {
+  return {_mm512_sub_pd(a.v, b.v)};
+}
+inline Pack<double> operator*(const Pack<double>& a, const Pack<double>& b) {
+  return {_mm512_mul_pd(a.v, b.v)};
+}
+inline Pack<double> operator/(const Pack<double>& a, const Pack<double>& b) {
+  return {_mm512_div_pd(a.v, b.v)};
+}
+inline Pack<double> operator-(const Pack<double>& a) {
+  return {_mm512_castsi512_pd(
+      _mm512_xor_si512(_mm512_castpd_si512(a.v),
+                       _mm512_set1_epi64(INT64_C(0x8000000000000000))))};
+}
+inline Pack<double> Abs(const Pack<double>& a) {
+  return {_mm512_castsi512_pd(
+      _mm512_and_si512(_mm512_castpd_si512(a.v),
+                       _mm512_set1_epi64(INT64_C(0x7fffffffffffffff))))};
+}
+
+inline Mask<double> operator<(const Pack<double>& a, const Pack<double>& b) {
+  return {_mm512_cmp_pd_mask(a.v, b.v, _CMP_LT_OQ)};
+}
+inline Mask<double> operator>(const Pack<double>& a, const Pack<double>& b) {
+  return {_mm512_cmp_pd_mask(a.v, b.v, _CMP_GT_OQ)};
+}
+inline Mask<double> operator>=(const Pack<double>& a, const Pack<double>& b) {
+  return {_mm512_cmp_pd_mask(a.v, b.v, _CMP_GE_OQ)};
+}
+
+inline Mask<double> operator&(const Mask<double>& a, const Mask<double>& b) {
+  return {static_cast<__mmask8>(a.v & b.v)};
+}
+
+// Lane-wise `mask ? if_true : if_false`.
+inline Pack<double> Select(const Mask<double>& mask,
+                           const Pack<double>& if_true,
+                           const Pack<double>& if_false) {
+  return {_mm512_mask_blend_pd(mask.v, if_false.v, if_true.v)};
+}
+
+template <>
+struct Mask<float> {
+  __mmask16 v;
+};
+
+template <>
+struct Pack<float> {
+  static constexpr const std::size_t kWidth = 16;
+
+  __m512 v;
+};
+
+inline Pack<float> Broadcast(const float value) {
+  return {_mm512_set1_ps(value)};
+}
+inline Pack<float> Load(const float* src) { return {_mm512_loadu_ps(src)}; }
+inline void Store(float* dst, const Pack<float>& p) {
+  _mm512_storeu_ps(dst, p.v);
+}
+
+inline Pack<float> operator+(const Pack<float>& a, const Pack<float>& b) {
+  return {_mm512_add_ps(a.v, b.v)};
+}
+inline Pack<float> operator-(const Pack<float>& a, const Pack<float>& b) {
+  return {_mm512_sub_ps(a.v, b.v)};
+}
+inline Pack<float> operator*(const Pack<float>& a, const Pack<float>& b) {
+  return {_mm512_mul_ps(a.v, b.v)};
+}
+inline Pack<float> operator/(const Pack<float>& a, const Pack<float>& b) {
+  return {_mm512_div_ps(a.v, b.v)};
+}
+inline Pack<float> operator-(const Pack<float>& a) {
+  return {_mm512_castsi512_ps(
+      _mm512_xor_si512(_mm512_castps_si512(a.v),
+                       _mm512_set1_epi32(INT32_C(0x80000000))))};
+}
+inline Pack<float> Abs(const Pack<float>& a) {
+  return {_mm512_castsi512_ps(
+      _mm512_and_si512(_mm512_castps_si512(a.v),
+                       _mm512_set1_epi32(INT32_C(0x7fffffff))))};
+}
+
+inline Mask<float> operator<(const Pack<float>& a, const Pack<float>& b) {
+  return {_mm512_cmp_ps_mask(a.v, b.v, _CMP_LT_OQ)};
+}
+inline Mask<float> operator>(const Pack<float>& a, const Pack<float>& b) {
+  return {_mm512_cmp_ps_mask(a.v, b.v, _CMP_GT_OQ)};
+}
+inline Mask<float> operator>=(const Pack<float>& a, const Pack<float>& b) {
+  return {_mm512_cmp_ps_mask(a.v, b.v, _CMP_GE_OQ)};
+}
+
+inline Mask<float> operator&(const Mask<float>& a, const Mask<float>& b) {
+  return {static_cast<__mmask16>(a.v & b.v)};
+}
+
+inline Pack<float> Select(const Mask<float>& mask, const Pack<float>& if_true,
+                          const Pack<float>& if_false) {
+  return {_mm512_mask_blend_ps(mask.v, if_false.v, if_true.v)};
+}
+
+#elif defined(__AVX__)
+
+template <>
+struct Mask<double> {
+  __m256d v;
+};
+
+template <>
+struct Pack<double> {
+  static constexpr const std::size_t kWidth = 4;
+
+  __m256d v;
+};
+
+inline Pack<double> Broadcast(const double value) {
+  return {_mm256_set1_pd(value)};
+}
+inline Pack<double> Load(const double* src) { return {_mm256_loadu_pd(src)}; }
+inline void Store(double* dst, const Pack<double>& p) {
+  _mm256_storeu_pd(dst, p.v);
+}
+
+inline Pack<double> operator+(const Pack<double>& a, const Pack<double>& b) {
+  return {_mm256_add_pd(a.v, b.v)};
+}
+inline Pack<double> operator-(const Pack<double>& a, const Pack<double>& b) {
+  return {_mm256_sub_pd(a.v, b.v)};
+}
+inline Pack<double> operator*(const Pack<double>& a, const Pack<double>& b) {
+  return {_mm256_mul_pd(a.v, b.v)};
+}
+inline Pack<double> operator/(const Pack<double>& a, const Pack<double>& b) {
+  return {_mm256_div_pd(a.v, b.v)};
+}
+inline Pack<double> operator-(const Pack<double>& a) {
+  return {_mm256_xor_pd(a.v, _mm256_set1_pd(-0.0))};
+}
+inline Pack<double> Abs(const Pack<double>& a) {
+  return {_mm256_andnot_pd(_mm256_set1_pd(-0.0), a.v)};
+}
+
+inline Mask<double> operator<(const Pack<double>& a, const Pack<double>& b) {
+  return {_mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ)};
+}
+inline Mask<double> operator>(const Pack<double>& a, const Pack<double>& b) {
+  return {_mm256_cmp_pd(a.v, b.v, _CMP_GT_OQ)};
+}
+inline Mask<double> operator>=(const Pack<double>& a, const Pack<double>& b) {
+  return {_mm256_cmp_pd(a.v, b.v, _CMP_GE_OQ)};
+}
+
+inline Mask<double> operator&(const Mask<double>& a, const Mask<double>& b) {
+  return {_mm256_and_pd(a.v, b.v)};
+}
+
+// Lane-wise `mask ? if_true : if_false`.
+inline Pack<double> Select(const Mask<double>& mask,
+                           const Pack<double>& if_true,
+                           const Pack<double>& if_false) {
+  return {_mm256_blendv_pd(if_false.v, if_true.v, mask.v)};
+}
+
+template <>
+struct Mask<float> {
+  __m256 v;
+};
+
+template <>
+struct Pack<float> {
+  static constexpr const std::size_t kWidth = 8;
+
+  __m256 v;
+};
+
+inline Pack<float> Broadcast(const float value) {
+  return {_mm256_set1_ps(value)};
+}
+inline Pack<float> Load(const float* src) { return {_mm256_loadu_ps(src)}; }
+inline void Store(float* dst, const Pack<float>& p) {
+  _mm256_storeu_ps(dst, p.v);
+}
+
+inline Pack<float> operator+(const Pack<float>& a, const Pack<float>& b) {
+  return {_mm256_add_ps(a.v, b.v)};
+}
+inline Pack<float> operator-(const Pack<float>& a, const Pack<float>& b) {
+  return {_mm256_sub_ps(a.v, b.v)};
+}
+inline Pack<float> operator*(const Pack<float>& a, const Pack<float>& b) {
+  return {_mm256_mul_ps(a.v, b.v)};
+}
+inline Pack<float> operator/(const Pack<float>& a, const Pack<float>& b) {
+  return {_mm256_div_ps(a.v, b.v)};
+}
+inline Pack<float> operator-(const Pack<float>& a) {
+  return {_mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f))};
+}
+inline Pack<float> Abs(const Pack<float>& a) {
+  return {_mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v)};
+}
+
+inline Mask<float> operator<(const Pack<float>& a, const Pack<float>& b) {
+  return {_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)};
+}
+inline Mask<float> operator>(const Pack<float>& a, const Pack<float>& b) {
+  return {_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ)};
+}
+inline Mask<float> operator>=(const Pack<float>& a, const Pack<float>& b) {
+  return {_mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ)};
+}
+
+inline Mask<float> operator&(const Mask<float>& a, const Mask<float>& b) {
+  return {_mm256_and_ps(a.v, b.v)};
+}
+
+inline Pack<float> Select(const Mask<float>& mask, const Pack<float>& if_true,
+                          const Pack<float>& if_false) {
+  return {_mm256_blendv_ps(if_false.v, if_true.v, mask.v)};
+}
+
+#else
+
+template <typename T>
+struct Mask {
+  bool v;
+};
+
+template <typename T>
+struct Pack {
+  static constexpr const std::size_t kWidth = 1;
+
+  T v;
+};
+
+template <typename T>
+inline Pack<T> Broadcast(const T value) {
+  return {value};
+}
+template <typename T>
+inline Pack<T> Load(const T* src) {
+  return {*src};
+}
+template <typename T>
+inline void Store(T* dst, const Pack<T>& p) {
+  *dst = p.v;
+}
+
+template <typename T>
+inline Pack<T> operator+(const Pack<T>& a, const Pack<T>& b) {
+  return {a.v + b.v};
+}
+template <typename T>
+inline Pack<T> operator-(const Pack<T>& a, const Pack<T>& b) {
+  return {a.v - b.v};
+}
+template <typename T>
+inline Pack<T> operator*(const Pack<T>& a, const Pack<T>& b) {
+  return {a.v * b.v};
+}
+template <typename T>
+inline Pack<T> operator/(const Pack<T>& a, const Pack<T>& b) {
+  return {a.v / b.v};
+}
+template <typename T>
+inline Pack<T> operator-(const Pack<T>& a) {
+  return {-a.v};
+}
+template <typename T>
+inline Pack<T> Abs(const Pack<T>& a) {
+  return {std::fabs(a.v)};
+}
+
+template <typename T>
+inline Mask<T> operator<(const Pack<T>& a, const Pack<T>& b) {
+  return {a.v < b.v};
+}
+template <typename T>
+inline Mask<T> operator>(const Pack<T>& a, const Pack<T>& b) {
+  return {a.v > b.v};
+}
+template <typename T>
+inline Mask<T> operator>=(const Pack<T>& a, const Pack<T>& b) {
+  return {a.v >= b.v};
+}
+
+template <typename T>
+inline Mask<T> operator&(const Mask<T>& a, const Mask<T>& b) {
+  return {a.v && b.v};
+}
+
+// Lane-wise `mask ? if_true : if_false`.
+template <typename T>
+inline Pack<T> Select(const Mask<T>& mask, const Pack<T>& if_true,
+                      const Pack<T>& if_false) {
+  return mask.v ? if_true : if_false;
+}
+
+#endif
+
+// Flushes subnormal results and operands to zero on the calling thread for
+// its lifetime, where the target allows it. Decaying signals otherwise end in
+// subnormals, which many processors handle orders of magnitude slower, and
+// much sooner in float than in double. Scalar and packed arithmetic flush
+// alike, so they still round identically under the guard.
+class FlushSubnormals {
+ public:
+#if defined(__SSE__)
+  // Flush to zero and denormals are zero.
+  static constexpr const unsigned int kFlags = 0x8040;
+
+  FlushSubnormals() : csr_(_mm_getcsr()) { _mm_setcsr(csr_ | kFlags); }
+  ~FlushSubnormals() { _mm_setcsr(csr_); }
+#else
+  FlushSubnormals() = default;
+  ~FlushSubnormals() = default;
+#endif
+
+  FlushSubnormals(const FlushSubnormals&) = delete;
+  FlushSubnormals& operator=(const FlushSubnormals&) = delete;
+
+#if defined(__SSE__)
+ private:
+  unsigned int csr_;
+#endif
+};
+
+}  // namespace control::simd
+
+#endif  // CONTROL_SIMD_H_
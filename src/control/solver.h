@@ -1,17 +1,32 @@
 #ifndef PID_SOLVER_H_
 #define PID_SOLVER_H_
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <cstddef>
 #include <limits>
+#include <vector>
 
+#include "control/batch_plant_control.h"
 #include "control/controller.h"
 #include "control/plant_control.h"
+#include "control/scenario.h"
+#include "control/state_space_plant.h"
 #include "ga/chromosome.h"
 #include "ga/procedure.h"
 
 namespace control {
 
-template <typename T = double, std::size_t N = control::Controller::kNumParams>
+// The scalar type chromosomes are simulated in. Float doubles the SIMD width
+// of batched simulations at the cost of accuracy.
+enum class Precision { kDouble, kFloat };
+
+// Tunes a PID controller for the plant P, StaticPlant or a StateSpacePlant.
+// P is simulated in double or float as set by precision(), whatever scalar
+// type it is declared with.
+template <typename T = double, std::size_t N = control::Controller::kNumParams,
+          typename P = StaticPlant<>>
 class Solver : public ga::Procedure<T, N> {
  public:
   static constexpr const double kMaxFitnessValue = 50.0;
@@ -21,34 +36,343 @@ class Solver : public ga::Procedure<T, N> {
   static constexpr const double kSettlingTimeWeight = 0.25;
   static constexpr const double kMaxOvershootWeight = 0.25;
 
+  // Number of (chromosome, scenario) pairs simulated in lockstep by one
+  // worker.
+  static constexpr const std::size_t kBatchSize = 16;
+
+  // The same for float precision. Twice as many lanes fit the same SIMD
+  // registers, so a batch takes as many instructions per sample as in double.
+  static constexpr const std::size_t kFloatBatchSize = 2 * kBatchSize;
+
+  // Bounded evaluations compare against the cost bound every this many
+  // samples, in both the scalar and the batched simulation.
+  static constexpr const std::size_t kAbortCheckInterval = 32;
+
+  // Screening simulations keep the sample time, since a coarser one can step
+  // over the narrow band the rise time is detected in, and stop at a fifth of
+  // the horizon. Good controllers rise and settle well within it.
+  static constexpr const System::Timing kDefaultScreeningTiming =
+      System::Timing(System::kSampleTimeSecs,
+                     System::kSimulationTimeSecs / 5.0);
+
   constexpr Solver(const typename ga::Procedure<T, N>::Args& args,
                    const std::vector<typename ga::Gene<T>::Bounds>& constraints)
-      : ga::Procedure<T, N>(args, constraints) {}
+      : ga::Procedure<T, N>(args, constraints),
+        screening_timing_(kDefaultScreeningTiming),
+        scenarios_(1),
+        aggregate_(Aggregate::kMean),
+        precision_(Precision::kDouble),
+        num_verified_elites_(0),
+        plant_controls_(1),
+        batch_plant_controls_(1),
+        scenario_fitnesses_(1) {}
 
   virtual constexpr ~Solver() = default;
 
+  // The timing of the low-fidelity simulations of multi-fidelity evaluation,
+  // see ga::Procedure::Args::screening_fraction.
+  constexpr const System::Timing& screening_timing() const {
+    return screening_timing_;
+  }
+  constexpr System::Timing& screening_timing() { return screening_timing_; }
+
+  // The scenarios every chromosome is simulated in, and how their fitnesses
+  // combine into its own. The default is the nominal unit step alone. Must
+  // not be empty, and weights must be positive.
+  const std::vector<Scenario>& scenarios() const { return scenarios_; }
+  std::vector<Scenario>& scenarios() { return scenarios_; }
+
+  constexpr const Aggregate aggregate() const { return aggregate_; }
+  constexpr Aggregate& aggregate() { return aggregate_; }
+
+  // The plant every chromosome is simulated on. Copied to the simulators
+  // when a run starts.
+  constexpr const P& plant() const { return plant_; }
+  constexpr P& plant() { return plant_; }
+
+  constexpr const Precision precision() const { return precision_; }
+  constexpr Precision& precision() { return precision_; }
+
+  // With float precision, the number of the best chromosomes of the final
+  // generation that are simulated again in double once the run stops. Their
+  // fitnesses are replaced by the double ones, and every other chromosome is
+  // ranked behind them, so the solution is always a verified one.
+  constexpr const std::size_t num_verified_elites() const {
+    return num_verified_elites_;
+  }
+  constexpr std::size_t& num_verified_elites() { return num_verified_elites_; }
+
  protected:
-  constexpr const double Fitness(const ga::Chromosome<T, N>& chromosome) final {
-    plant_control_.controller().params().k_p = chromosome[0].value();
-    plant_control_.controller().params().t_i = chromosome[1].value();
-    plant_control_.controller().params().t_d = chromosome[2].value();
-
-    auto response = plant_control_.StepResponse();
-    if (!response.rise_time.has_value() ||
-        !response.settling_time.has_value() ||
-        !response.max_overshoot.has_value()) {
+  // Stops simulating as soon as the chromosome provably cannot beat
+  // `cost_bound`, in which case the returned fitness is a lower bound that is
+  // still greater than `cost_bound`. Scenarios are simulated one after the
+  // other and the bound applies to their aggregate, so a chromosome that
+  // fails an early scenario badly skips the rest.
+  constexpr const double Fitness(const ga::Chromosome<T, N>& chromosome,
+                                 const std::size_t worker,
+                                 const double cost_bound) final {
+    if (precision_ == Precision::kFloat) {
+      auto flush_subnormals = simd::FlushSubnormals();
+      return Simulate(float_plant_controls_[worker], chromosome, worker,
+                      cost_bound);
+    }
+
+    return Simulate(plant_controls_[worker], chromosome, worker, cost_bound);
+  }
+
+  template <typename S>
+  const double Simulate(S& plant_control,
+                        const ga::Chromosome<T, N>& chromosome,
+                        const std::size_t worker, const double cost_bound) {
+    plant_control.controller().params().k_p = chromosome[0].value();
+    plant_control.controller().params().t_i = chromosome[1].value();
+    plant_control.controller().params().t_d = chromosome[2].value();
+
+    auto& fitnesses = scenario_fitnesses_[worker];
+    fitnesses.assign(scenarios_.size(), 0.0);
+    for (std::size_t i = 0; i < scenarios_.size(); ++i) {
+      scenarios_[i].Apply(plant_control);
+      auto response = plant_control.StepResponse(
+          false,
+          [this, i, cost_bound, &fitnesses](const auto& partial,
+                                            const double time) {
+            if (partial.num_samples % kAbortCheckInterval != 0) {
+              return false;
+            }
+
+            fitnesses[i] = FitnessLowerBound(partial, time);
+            return AggregateFitness(aggregate_, scenarios_,
+                                    fitnesses.data()) > cost_bound;
+          });
+
+      this->CountSimulation(worker, response.num_samples, response.aborted);
+
+      fitnesses[i] = ResponseFitness(response, fitnesses[i]);
+      if (response.aborted) {
+        break;
+      }
+    }
+
+    return AggregateFitness(aggregate_, scenarios_, fitnesses.data());
+  }
+
+  // Small enough that a batch fills the lanes once with every scenario of
+  // its chromosomes, so that more scenarios spread over more workers.
+  constexpr const std::size_t batch_size() const final {
+    auto num_lanes =
+        precision_ == Precision::kFloat ? kFloatBatchSize : kBatchSize;
+    return std::max(std::size_t(1),
+                    num_lanes / std::max(std::size_t(1), scenarios_.size()));
+  }
+
+  // Simulates the whole batch in lockstep, see BatchPlantControl.
+  void FitnessBatch(ga::Chromosome<T, N>* const* chromosomes,
+                    const std::size_t count, const std::size_t worker,
+                    const double cost_bound) final {
+    SimulateBatch(chromosomes, count, worker, cost_bound, System::Timing());
+  }
+
+  constexpr const bool supports_screening() const final { return true; }
+
+  // Scores the batch like FitnessBatch, but with the screening timing.
+  void ScreenBatch(ga::Chromosome<T, N>* const* chromosomes,
+                   const std::size_t count, const std::size_t worker,
+                   const double cost_bound) final {
+    SimulateBatch(chromosomes, count, worker, cost_bound, screening_timing_);
+  }
+
+  // Every (chromosome, scenario) pair is a job. Jobs fill the lanes in order,
+  // chromosome by chromosome, and the cost bound applies to the aggregate of
+  // each chromosome's jobs, as in Fitness. Jobs of a chromosome that is
+  // already known to lose are skipped.
+  void SimulateBatch(ga::Chromosome<T, N>* const* chromosomes,
+                     const std::size_t count, const std::size_t worker,
+                     const double cost_bound, const System::Timing& timing) {
+    if (precision_ == Precision::kFloat) {
+      auto flush_subnormals = simd::FlushSubnormals();
+      SimulateBatch(float_batch_plant_controls_[worker], chromosomes, count,
+                    worker, cost_bound, timing);
+    } else {
+      SimulateBatch(batch_plant_controls_[worker], chromosomes, count, worker,
+                    cost_bound, timing);
+    }
+  }
+
+  template <typename B>
+  void SimulateBatch(B& batch_plant_control,
+                     ga::Chromosome<T, N>* const* chromosomes,
+                     const std::size_t count, const std::size_t worker,
+                     const double cost_bound, const System::Timing& timing) {
+    constexpr auto kNumLanes = B::kNumLanes;
+    batch_plant_control.set_timing(timing);
+
+    auto num_scenarios = scenarios_.size();
+    auto num_jobs = count * num_scenarios;
+    auto& fitnesses = scenario_fitnesses_[worker];
+    fitnesses.assign(num_jobs, 0.0);
+
+    auto aggregate = [this, &fitnesses, num_scenarios](const std::size_t job) {
+      return AggregateFitness(
+          aggregate_, scenarios_,
+          &fitnesses[(job / num_scenarios) * num_scenarios]);
+    };
+
+    auto lane_jobs = std::array<std::size_t, kNumLanes>();
+    for (std::size_t next_job = 0; next_job < num_jobs;) {
+      std::size_t num_lanes = 0;
+      for (; num_lanes < kNumLanes && next_job < num_jobs; ++next_job) {
+        if (aggregate(next_job) > cost_bound) {
+          continue;
+        }
+
+        const auto& chromosome = *chromosomes[next_job / num_scenarios];
+        auto& params = batch_plant_control.params()[num_lanes];
+        params.k_p = chromosome[0].value();
+        params.t_i = chromosome[1].value();
+        params.t_d = chromosome[2].value();
+        batch_plant_control.scenarios()[num_lanes] =
+            scenarios_[next_job % num_scenarios];
+
+        lane_jobs[num_lanes++] = next_job;
+      }
+
+      if (num_lanes == 0) {
+        break;
+      }
+
+      auto responses = batch_plant_control.StepResponse(
+          num_lanes,
+          [cost_bound, &fitnesses, &lane_jobs, &aggregate](
+              const std::size_t lane, const auto& partial, const double time) {
+            fitnesses[lane_jobs[lane]] = FitnessLowerBound(partial, time);
+            return aggregate(lane_jobs[lane]) > cost_bound;
+          },
+          kAbortCheckInterval);
+
+      for (std::size_t lane = 0; lane < num_lanes; ++lane) {
+        auto job = lane_jobs[lane];
+        fitnesses[job] = ResponseFitness(responses[lane], fitnesses[job]);
+        this->CountSimulation(worker, responses[lane].num_samples,
+                              responses[lane].aborted);
+      }
+    }
+
+    for (std::size_t i = 0; i < count; ++i) {
+      chromosomes[i]->fitness() = aggregate(i * num_scenarios);
+    }
+  }
+
+  template <typename Response>
+  static constexpr const double ResponseFitness(const Response& response,
+                                                const double lower_bound) {
+    if (response.aborted) {
+      return lower_bound;
+    } else if (!response.rise_time.has_value() ||
+               !response.settling_time.has_value() ||
+               !response.max_overshoot.has_value()) {
       return kMaxFitnessValue;
     } else {
-      return (kIntegralSquaredErrorWeight *
-              plant_control_.IntegralSquaredError(response)) +
+      return (kIntegralSquaredErrorWeight * response.integral_squared_error) +
              (kRiseTimeWeight * response.rise_time.value()) +
              (kSettlingTimeWeight * response.settling_time.value()) +
              (kMaxOvershootWeight * response.max_overshoot.value());
     }
   }
 
+  // The fitness of a response simulated up to `time` can only grow: the
+  // integral squared error keeps accumulating, a pending rise or settling time
+  // lies after `time`, and any overshoot is at least the set point. A response
+  // that never rises, settles or overshoots is capped at kMaxFitnessValue.
+  template <typename Response>
+  static constexpr const double FitnessLowerBound(const Response& response,
+                                                  const double time) {
+    double lower_bound =
+        (kIntegralSquaredErrorWeight * response.integral_squared_error) +
+        (kRiseTimeWeight * response.rise_time.value_or(time)) +
+        (kSettlingTimeWeight * response.settling_time.value_or(time)) +
+        (kMaxOvershootWeight *
+         std::max<double>(Controller::kUnitStepSetPoint,
+                          response.max_overshoot.value_or(
+                              Controller::kUnitStepSetPoint)));
+
+    return std::min(lower_bound, kMaxFitnessValue);
+  }
+
+  // Elites are verified in double on the first worker's simulator, which
+  // the double plant is always reserved for.
+  void OnFinish(std::vector<ga::Chromosome<T, N>>& generation) final {
+    auto num_elites = std::min(num_verified_elites_, generation.size());
+    if (precision_ != Precision::kFloat || num_elites == 0) {
+      return;
+    }
+
+    std::partial_sort(generation.begin(), generation.begin() + num_elites,
+                      generation.end(),
+                      typename ga::Procedure<T, N>::CompareFitness());
+
+    double worst_verified = -std::numeric_limits<double>::infinity();
+    for (std::size_t i = 0; i < num_elites; ++i) {
+      generation[i].fitness() =
+          Simulate(plant_controls_[0], generation[i], 0,
+                   std::numeric_limits<double>::infinity());
+      worst_verified = std::max(worst_verified, generation[i].fitness());
+    }
+
+    for (std::size_t i = num_elites; i < generation.size(); ++i) {
+      auto& fitness = generation[i].fitness();
+      if (fitness <= worst_verified) {
+        fitness = std::nextafter(worst_verified,
+                                 std::numeric_limits<double>::infinity());
+      }
+    }
+  }
+
+  void ReserveWorkers(const std::size_t num_workers) final {
+    auto is_float = precision_ == Precision::kFloat;
+    plant_controls_.resize(is_float ? 1 : num_workers);
+    batch_plant_controls_.resize(is_float ? 0 : num_workers);
+    float_plant_controls_.resize(is_float ? num_workers : 0);
+    float_batch_plant_controls_.resize(is_float ? num_workers : 0);
+    scenario_fitnesses_.resize(num_workers);
+
+    for (auto& plant_control : plant_controls_) {
+      plant_control.plant() = DoublePlant(plant_);
+    }
+    for (auto& batch_plant_control : batch_plant_controls_) {
+      batch_plant_control.plant() = DoublePlant(plant_);
+    }
+    for (auto& plant_control : float_plant_controls_) {
+      plant_control.plant() = FloatPlant(plant_);
+    }
+    for (auto& batch_plant_control : float_batch_plant_controls_) {
+      batch_plant_control.plant() = FloatPlant(plant_);
+    }
+  }
+
  private:
-  PlantControl plant_control_;
+  System::Timing screening_timing_;
+
+  using DoublePlant = typename P::template Rebind<double>;
+  using FloatPlant = typename P::template Rebind<float>;
+
+  std::vector<Scenario> scenarios_;
+  Aggregate aggregate_;
+  P plant_;
+  Precision precision_;
+  std::size_t num_verified_elites_;
+
+  // One simulator per evaluation worker in each precision, and the fitness or
+  // its lower bound for every (chromosome, scenario) pair the worker is
+  // simulating. Only the first worker's double simulator is reserved under
+  // float precision.
+  std::vector<StaticPlantControl<StaticController<double>, DoublePlant>>
+      plant_controls_;
+  std::vector<BatchPlantControl<kBatchSize, DoublePlant>> batch_plant_controls_;
+  std::vector<StaticPlantControl<StaticController<float>, FloatPlant>>
+      float_plant_controls_;
+  std::vector<BatchPlantControl<kFloatBatchSize, FloatPlant>>
+      float_batch_plant_controls_;
+  std::vector<std::vector<double>> scenario_fitnesses_;
 };
 
 }  // namespace control
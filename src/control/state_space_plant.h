@@ -0,0 +1,303 @@
+#ifndef CONTROL_STATE_SPACE_PLANT_H_
+#define CONTROL_STATE_SPACE_PLANT_H_
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+
+#include "control/plant.h"
+#include "control/static_system.h"
+
+namespace control {
+
+// A linear time-invariant model of compile-time order,
+//   x' = a x + b u,  y = c x + d u,
+// where x' is the derivative of the state for a continuous model and the next
+// state for a discrete one. Models are built and discretized in double and
+// may then be rounded to the scalar type of a simulation.
+template <std::size_t Order, typename T = double>
+struct StateSpace {
+  static_assert(Order > 0, "A state-space model needs at least one state");
+
+  using Vector = std::array<T, Order>;
+  using Matrix = std::array<Vector, Order>;
+
+  // The controllable canonical realization of the transfer function
+  //   (numerator[0] s^n + ... + numerator[n]) /
+  //   (denominator[0] s^n + ... + denominator[n]).
+  static constexpr const StateSpace FromTransferFunction(
+      const std::array<double, Order + 1>& numerator,
+      const std::array<double, Order + 1>& denominator) {
+    if (denominator[0] == 0.0) {
+      throw std::invalid_argument("Transfer function is not proper");
+    }
+
+    auto model = StateSpace();
+    model.d = numerator[0] / denominator[0];
+    for (std::size_t i = 0; i < Order; ++i) {
+      if (i + 1 < Order) {
+        model.a[i][i + 1] = 1.0;
+      }
+
+      auto den = denominator[Order - i] / denominator[0];
+      model.a[Order - 1][i] = -den;
+      model.c[i] = numerator[Order - i] / denominator[0] - den * model.d;
+    }
+    model.b[Order - 1] = 1.0;
+
+    return model;
+  }
+
+  // The backward Euler discretization of a continuous model, the method
+  // Plant::Model uses: (I - T a) x[k+1] = x[k] + T b u[k], with the output
+  // read from the new state. Throws if I - T a is singular.
+  constexpr const StateSpace Discretize(const double sample_time) const {
+    // Gauss-Jordan elimination of [I - T a | I] with partial pivoting.
+    auto m = Matrix();
+    auto inverse = Matrix();
+    for (std::size_t i = 0; i < Order; ++i) {
+      for (std::size_t j = 0; j < Order; ++j) {
+        m[i][j] = (i == j ? 1.0 : 0.0) - sample_time * a[i][j];
+      }
+      inverse[i][i] = 1.0;
+    }
+
+    auto abs = [](const double value) { return value < 0.0 ? -value : value; };
+    for (std::size_t column = 0; column < Order; ++column) {
+      auto pivot = column;
+      for (std::size_t i = column + 1; i < Order; ++i) {
+        if (abs(m[i][column]) > abs(m[pivot][column])) {
+          pivot = i;
+        }
+      }
+
+      if (m[pivot][column] == 0.0) {
+        throw std::invalid_argument("State-space model cannot be discretized");
+      }
+
+      std::swap(m[pivot], m[column]);
+      std::swap(inverse[pivot], inverse[column]);
+
+      auto scale = 1.0 / m[column][column];
+      for (std::size_t j = 0; j < Order; ++j) {
+        m[column][j] *= scale;
+        inverse[column][j] *= scale;
+      }
+
+      for (std::size_t i = 0; i < Order; ++i) {
+        auto factor = m[i][column];
+        if (i == column || factor == 0.0) {
+          continue;
+        }
+
+        for (std::size_t j = 0; j < Order; ++j) {
+          m[i][j] -= factor * m[column][j];
+          inverse[i][j] -= factor * inverse[column][j];
+        }
+      }
+    }
+
+    auto discrete = StateSpace();
+    discrete.a = inverse;
+    for (std::size_t i = 0; i < Order; ++i) {
+      for (std::size_t j = 0; j < Order; ++j) {
+        discrete.b[i] += inverse[i][j] * sample_time * b[j];
+      }
+    }
+    discrete.c = c;
+    discrete.d = d;
+
+    return discrete;
+  }
+
+  template <typename U>
+  constexpr const StateSpace<Order, U> Cast() const {
+    auto model = StateSpace<Order, U>();
+    for (std::size_t i = 0; i < Order; ++i) {
+      for (std::size_t j = 0; j < Order; ++j) {
+        model.a[i][j] = U(a[i][j]);
+      }
+      model.b[i] = U(b[i]);
+      model.c[i] = U(c[i]);
+    }
+    model.d = U(d);
+
+    return model;
+  }
+
+  Matrix a = {};
+  Vector b = {};
+  Vector c = {};
+  T d = 0.0;
+};
+
+// A plant given by a continuous state-space model of order `Order`, whose
+// input arrives after a dead time of up to `MaxDelay` samples. The model is
+// discretized on every reset, so it, the dead time and the timing can all
+// change between simulations. The update is unrolled over the order at
+// compile time, so low orders cost little more per sample than StaticPlant,
+// which it replaces in StaticPlantControl and Solver. The simulation runs in
+// the scalar type T.
+template <std::size_t Order, std::size_t MaxDelay = 0, typename T = double>
+class StateSpacePlant
+    : public StaticSystem<StateSpacePlant<Order, MaxDelay, T>, T> {
+ public:
+  using Disturbance = Plant::Disturbance;
+  using Model = StateSpace<Order>;
+  using DiscreteModel = StateSpace<Order, T>;
+
+  // The same plant simulated in another scalar type.
+  template <typename U>
+  using Rebind = StateSpacePlant<Order, MaxDelay, U>;
+
+  static constexpr const std::size_t kOrder = Order;
+  static constexpr const std::size_t kMaxDelay = MaxDelay;
+
+  constexpr StateSpacePlant(const Model& model = Model(),
+                            const double dead_time = 0.0)
+      : StaticSystem<StateSpacePlant<Order, MaxDelay, T>, T>(),
+        model_(model),
+        dead_time_(dead_time),
+        state_(),
+        delay_line_(),
+        delay_(0),
+        delay_head_(0),
+        elapsed_(0.0) {}
+
+  // Copies the configuration of `plant`, but not its state.
+  template <typename U>
+  constexpr explicit StateSpacePlant(
+      const StateSpacePlant<Order, MaxDelay, U>& plant)
+      : StateSpacePlant(plant.model(), plant.dead_time()) {
+    disturbance_ = plant.disturbance();
+  }
+
+  constexpr ~StateSpacePlant() = default;
+
+  // The continuous model.
+  constexpr const Model& model() const { return model_; }
+  constexpr Model& model() { return model_; }
+
+  // The dead time in seconds, rounded to whole samples.
+  constexpr const double dead_time() const { return dead_time_; }
+  constexpr double& dead_time() { return dead_time_; }
+
+  constexpr const Disturbance& disturbance() const { return disturbance_; }
+  constexpr Disturbance& disturbance() { return disturbance_; }
+
+  // Discretizes the model for the current timing and clears the state.
+  // Throws if the dead time exceeds MaxDelay samples.
+  constexpr void reset() {
+    StaticSystem<StateSpacePlant<Order, MaxDelay, T>, T>::reset();
+    discrete_ = model_.Discretize(this->sample_time()).template Cast<T>();
+    delay_ = DelaySamples(dead_time_, this->sample_time());
+    state_.fill(0.0);
+    delay_line_.fill(0.0);
+    delay_head_ = 0;
+    elapsed_ = 0.0;
+  }
+
+  static constexpr const std::size_t DelaySamples(const double dead_time,
+                                                  const double sample_time) {
+    auto samples = dead_time / sample_time + 0.5;
+    if (!(samples >= 0.0 && samples < MaxDelay + 1.0)) {
+      throw std::invalid_argument("Dead time exceeds the plant's delay line");
+    }
+
+    return static_cast<std::size_t>(samples);
+  }
+
+  // Advances `state` by one sample of the discrete `model` and returns the
+  // output. Shared with the batched simulation, where `V` is simd::Pack and
+  // `constant` broadcasts a coefficient, so that both round identically.
+  template <typename V, typename Constant>
+  static constexpr const V Update(const DiscreteModel& model,
+                                  std::array<V, Order>& state, const V& input,
+                                  Constant&& constant) {
+    return UpdateUnrolled(model, state, input, constant,
+                          std::make_index_sequence<Order>());
+  }
+
+ private:
+  friend class StaticSystem<StateSpacePlant<Order, MaxDelay, T>, T>;
+
+  constexpr const T Transform(const T input) {
+    auto delayed = Delay(input + disturbance_.at<T>(elapsed_));
+    elapsed_ += this->sample_time();
+
+    return Update(discrete_, state_, delayed,
+                  [](const T value) { return value; });
+  }
+
+  constexpr const T Delay(const T input) {
+    if constexpr (MaxDelay == 0) {
+      return input;
+    } else {
+      if (delay_ == 0) {
+        return input;
+      }
+
+      auto delayed = delay_line_[delay_head_];
+      delay_line_[delay_head_] = input;
+      if (++delay_head_ == delay_) {
+        delay_head_ = 0;
+      }
+
+      return delayed;
+    }
+  }
+
+  template <typename V, typename Constant, std::size_t... I>
+  static constexpr const V UpdateUnrolled(const DiscreteModel& model,
+                                          std::array<V, Order>& state,
+                                          const V& input, Constant& constant,
+                                          std::index_sequence<I...> indices) {
+    state = std::array<V, Order>{
+        Dot(model.a[I], state, constant(model.b[I]) * input, constant,
+            indices)...};
+
+    return Dot(model.c, state, constant(model.d) * input, constant, indices);
+  }
+
+  // offset + coefficients . values. The products are added pairwise, which
+  // shortens the dependency chain from one sample to the next.
+  template <typename V, typename Constant, std::size_t... I>
+  static constexpr const V Dot(
+      const typename DiscreteModel::Vector& coefficients,
+      const std::array<V, Order>& values, const V& offset, Constant& constant,
+      std::index_sequence<I...>) {
+    auto products =
+        std::array<V, Order>{(constant(coefficients[I]) * values[I])...};
+
+    return offset + Sum<0, Order>(products);
+  }
+
+  template <std::size_t Begin, std::size_t End, typename V>
+  static constexpr const V Sum(const std::array<V, Order>& terms) {
+    if constexpr (End - Begin == 1) {
+      return terms[Begin];
+    } else {
+      constexpr auto middle = Begin + (End - Begin) / 2;
+      return Sum<Begin, middle>(terms) + Sum<middle, End>(terms);
+    }
+  }
+
+  Model model_;
+  double dead_time_;
+  Disturbance disturbance_;
+
+  DiscreteModel discrete_;
+  std::array<T, Order> state_;
+
+  // A ring of the last `delay_` inputs; `delay_head_` is the oldest.
+  std::array<T, MaxDelay> delay_line_;
+  std::size_t delay_;
+  std::size_t delay_head_;
+
+  double elapsed_;
+};
+
+}  // namespace control
+
+#endif  // CONTROL_STATE_SPACE_PLANT_H_
@@ -0,0 +1,47 @@
+#ifndef CONTROL_STATIC_SYSTEM_H_
+#define CONTROL_STATIC_SYSTEM_H_
+
+#include "control/system.h"
+
+namespace control {
+
+// Compile-time counterpart of System. Derived classes provide a non-virtual
+// `Transform(input)` and are composed by type, so a closed loop built from
+// static systems inlines into a single loop body. Signals and state are of
+// the scalar type T, while parameters and timing stay double.
+template <typename Derived, typename T = double>
+class StaticSystem {
+ public:
+  using Response = System::BasicResponse<T>;
+  using Timing = System::Timing;
+  using value_type = T;
+
+  static constexpr const double kSimulationTimeSecs =
+      System::kSimulationTimeSecs;
+  static constexpr const double kSampleTimeSecs = System::kSampleTimeSecs;
+
+  constexpr StaticSystem() = default;
+  constexpr ~StaticSystem() = default;
+
+  constexpr void reset() { output_ = 0.0; }
+
+  constexpr const Timing& timing() const { return timing_; }
+  constexpr void set_timing(const Timing& timing) { timing_ = timing; }
+
+  constexpr const T update_output(const T input) {
+    output_ = static_cast<Derived*>(this)->Transform(input);
+    return output_;
+  }
+
+ protected:
+  constexpr const T output() const { return output_; }
+  constexpr const double sample_time() const { return timing_.sample_time; }
+
+ private:
+  T output_;
+  Timing timing_;
+};
+
+}  // namespace control
+
+#endif  // CONTROL_STATIC_SYSTEM_H_
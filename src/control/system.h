@@ -1,6 +1,7 @@
 #ifndef CONTROL_SYSTEM_H_
 #define CONTROL_SYSTEM_H_
 
+#include <cstddef>
 #include <fstream>
 #include <iostream>
 #include <limits>
@@ -12,46 +13,77 @@ namespace control {
 
 class System {
  public:
-  struct Response {
+  // A step response simulated in the scalar type T. Float responses keep a
+  // trace of half the size.
+  template <typename T>
+  struct BasicResponse {
     struct TimeValue {
-      constexpr TimeValue(const double time = 0.0, const double value = 0.0)
+      constexpr TimeValue(const T time = 0.0, const T value = 0.0)
           : time(time), value(value) {}
 
       constexpr ~TimeValue() = default;
 
-      double time;
-      double value;
+      T time;
+      T value;
     };
 
-    Response() = default;
-    ~Response() = default;
+    BasicResponse() = default;
+    ~BasicResponse() = default;
 
     std::vector<TimeValue> time_values;
-    std::optional<double> rise_time;
-    std::optional<double> settling_time;
-    std::optional<double> max_overshoot;
+    std::size_t num_samples = 0;
+    bool aborted = false;
+    T integral_squared_error = 0.0;
+    std::optional<T> rise_time;
+    std::optional<T> settling_time;
+    std::optional<T> max_overshoot;
   };
 
+  using Response = BasicResponse<double>;
+  using value_type = double;
+
   static constexpr const double kSimulationTimeSecs = 100.0;
   static constexpr const double kSampleTimeSecs = 0.01;
 
+  // The sample time and horizon of a simulation. The models are tuned for
+  // the defaults; coarser timings trade accuracy for speed.
+  struct Timing {
+    constexpr Timing(const double sample_time = kSampleTimeSecs,
+                     const double simulation_time = kSimulationTimeSecs)
+        : sample_time(sample_time), simulation_time(simulation_time) {}
+
+    constexpr ~Timing() = default;
+
+    constexpr const std::size_t num_samples() const {
+      return static_cast<std::size_t>(simulation_time / sample_time) + 1;
+    }
+
+    double sample_time;
+    double simulation_time;
+  };
+
   constexpr System() = default;
   virtual constexpr ~System() = default;
 
   virtual constexpr void reset() { output_ = 0.0; }
 
+  constexpr const Timing& timing() const { return timing_; }
+  virtual constexpr void set_timing(const Timing& timing) { timing_ = timing; }
+
   constexpr const double update_output(const double input) {
     output_ = Transform(input);
     return output_;
   }
 
+  template <typename T>
   static void WriteResponseToFile(const std::string& file_name,
-                                  const Response& response) {
+                                  const BasicResponse<T>& response) {
     auto csv_file = std::ofstream(file_name.c_str(), std::fstream::out);
 
+    // Rows are buffered and only flushed when the file is closed.
     csv_file << "time,value\n";
     for (const auto& [time, value] : response.time_values) {
-      csv_file << time << "," << value << std::endl;
+      csv_file << time << "," << value << "\n";
     }
 
     csv_file.close();
@@ -59,24 +91,28 @@ class System {
 
  protected:
   constexpr const double output() const { return output_; }
+  constexpr const double sample_time() const { return timing_.sample_time; }
 
   virtual constexpr const double Transform(const double input) = 0;
 
  private:
   double output_;
+  Timing timing_;
 };
 
-std::ostream& operator<<(std::ostream& os, const System::Response& response) {
+template <typename T>
+std::ostream& operator<<(std::ostream& os,
+                         const System::BasicResponse<T>& response) {
   os << "Rise time:\t"
-     << response.rise_time.value_or(std::numeric_limits<double>::min())
+     << response.rise_time.value_or(std::numeric_limits<T>::min())
      << std::endl;
 
   os << "Settling time:\t"
-     << response.settling_time.value_or(std::numeric_limits<double>::min())
+     << response.settling_time.value_or(std::numeric_limits<T>::min())
      << std::endl;
 
   os << "Max overshoot:\t"
-     << response.max_overshoot.value_or(std::numeric_limits<double>::min());
+     << response.max_overshoot.value_or(std::numeric_limits<T>::min());
 
   return os;
 }
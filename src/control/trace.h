@@ -0,0 +1,252 @@
+#ifndef CONTROL_TRACE_H_
+#define CONTROL_TRACE_H_
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "control/system.h"
+
+namespace control {
+
+// Columnar binary step response trace: a fixed-size header with the sample
+// time, the number of samples and the response metrics, followed by the
+// sampled values as one contiguous array of doubles in host byte order. The
+// time of sample i is implicitly i * sample_time. Metrics that never happened
+// are stored as NaN.
+struct TraceHeader {
+  static constexpr const char kMagic[8] = {'P', 'I', 'D', 'T',
+                                           'R', 'A', 'C', 'E'};
+  static constexpr const std::uint32_t kVersion = 1;
+  static constexpr const std::uint32_t kAborted = 1;
+
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t header_size;
+  std::uint64_t num_samples;
+  double sample_time;
+  double integral_squared_error;
+  double rise_time;
+  double settling_time;
+  double max_overshoot;
+  std::uint32_t flags;
+  std::uint32_t reserved;
+};
+
+static_assert(sizeof(TraceHeader) == 72, "TraceHeader must be packed");
+static_assert(sizeof(TraceHeader) % alignof(double) == 0,
+              "Trace values must be aligned");
+
+// Writes the recorded trace of `response` with a single gathered write.
+// Responses simulated in float are widened, so the format stays the same.
+template <typename T>
+void WriteTrace(const std::string& file_name,
+                const System::BasicResponse<T>& response,
+                const double sample_time = System::kSampleTimeSecs) {
+  auto nan = std::numeric_limits<double>::quiet_NaN();
+
+  auto header = TraceHeader();
+  std::memcpy(header.magic, TraceHeader::kMagic, sizeof(header.magic));
+  header.version = TraceHeader::kVersion;
+  header.header_size = sizeof(TraceHeader);
+  header.num_samples = response.time_values.size();
+  header.sample_time = sample_time;
+  header.integral_squared_error = response.integral_squared_error;
+  header.rise_time = response.rise_time.value_or(nan);
+  header.settling_time = response.settling_time.value_or(nan);
+  header.max_overshoot = response.max_overshoot.value_or(nan);
+  header.flags = response.aborted ? TraceHeader::kAborted : 0;
+  header.reserved = 0;
+
+  auto values = std::vector<double>(response.time_values.size());
+  for (std::size_t i = 0, size = values.size(); i < size; ++i) {
+    values[i] = response.time_values[i].value;
+  }
+
+  auto fd = ::open(file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    throw std::system_error(errno, std::generic_category(), file_name);
+  }
+
+  // A single gathered write, continued if the kernel takes less than all of
+  // it.
+  iovec chunks[2] = {{&header, sizeof(header)},
+                     {values.data(), values.size() * sizeof(double)}};
+  auto* chunk = chunks;
+  int num_chunks = 2;
+  while (num_chunks > 0) {
+    auto written = ::writev(fd, chunk, num_chunks);
+    if (written < 0 && errno == EINTR) {
+      continue;
+    } else if (written < 0) {
+      auto error = errno;
+      ::close(fd);
+      throw std::system_error(error, std::generic_category(), file_name);
+    }
+
+    auto remaining = static_cast<std::size_t>(written);
+    while (num_chunks > 0 && remaining >= chunk->iov_len) {
+      remaining -= chunk->iov_len;
+      ++chunk;
+      --num_chunks;
+    }
+
+    if (num_chunks > 0) {
+      chunk->iov_base = static_cast<char*>(chunk->iov_base) + remaining;
+      chunk->iov_len -= remaining;
+    }
+  }
+
+  ::close(fd);
+}
+
+// A read-only, zero-copy view of a trace file.
+class MappedTrace {
+ public:
+  explicit MappedTrace(const std::string& file_name)
+      : data_(nullptr), size_(0) {
+    auto fd = ::open(file_name.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::system_error(errno, std::generic_category(), file_name);
+    }
+
+    struct stat status;
+    if (::fstat(fd, &status) != 0) {
+      auto error = errno;
+      ::close(fd);
+      throw std::system_error(error, std::generic_category(), file_name);
+    }
+
+    size_ = static_cast<std::size_t>(status.st_size);
+    if (size_ >= sizeof(TraceHeader)) {
+      data_ = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    }
+
+    auto error = errno;
+    ::close(fd);
+    if (data_ == MAP_FAILED) {
+      data_ = nullptr;
+      throw std::system_error(error, std::generic_category(), file_name);
+    }
+
+    if (!data_ ||
+        std::memcmp(header().magic, TraceHeader::kMagic,
+                    sizeof(TraceHeader::kMagic)) != 0 ||
+        header().version != TraceHeader::kVersion ||
+        header().header_size != sizeof(TraceHeader) ||
+        (size_ - sizeof(TraceHeader)) / sizeof(double) <
+            header().num_samples) {
+      Unmap();
+      throw std::runtime_error(file_name + ": not a trace file");
+    }
+  }
+
+  MappedTrace(MappedTrace&& trace) : data_(trace.data_), size_(trace.size_) {
+    trace.data_ = nullptr;
+    trace.size_ = 0;
+  }
+
+  MappedTrace& operator=(MappedTrace&& trace) {
+    if (this != &trace) {
+      Unmap();
+      data_ = trace.data_;
+      size_ = trace.size_;
+      trace.data_ = nullptr;
+      trace.size_ = 0;
+    }
+
+    return *this;
+  }
+
+  MappedTrace(const MappedTrace&) = delete;
+  MappedTrace& operator=(const MappedTrace&) = delete;
+
+  ~MappedTrace() { Unmap(); }
+
+  const TraceHeader& header() const {
+    return *static_cast<const TraceHeader*>(data_);
+  }
+
+  const std::size_t num_samples() const { return header().num_samples; }
+  const double sample_time() const { return header().sample_time; }
+
+  const double time(const std::size_t i) const { return i * sample_time(); }
+
+  const double* values() const {
+    return reinterpret_cast<const double*>(static_cast<const char*>(data_) +
+                                           sizeof(TraceHeader));
+  }
+
+  // The metrics stored with the trace. The values are only copied into
+  // `time_values` when `record_time_values` is set.
+  const System::Response response(const bool record_time_values = false) const {
+    auto response = System::Response();
+    response.num_samples = num_samples();
+    response.aborted = (header().flags & TraceHeader::kAborted) != 0;
+    response.integral_squared_error = header().integral_squared_error;
+    response.rise_time = Metric(header().rise_time);
+    response.settling_time = Metric(header().settling_time);
+    response.max_overshoot = Metric(header().max_overshoot);
+
+    if (record_time_values) {
+      response.time_values.reserve(num_samples());
+      for (std::size_t i = 0, size = num_samples(); i < size; ++i) {
+        response.time_values.push_back(
+            System::Response::TimeValue(time(i), values()[i]));
+      }
+    }
+
+    return response;
+  }
+
+  // Writes the trace in the format of System::WriteResponseToFile.
+  void WriteCsv(const std::string& file_name) const {
+    auto csv_file = std::ofstream(file_name.c_str(), std::fstream::out);
+
+    csv_file << "time,value\n";
+    for (std::size_t i = 0, size = num_samples(); i < size; ++i) {
+      csv_file << time(i) << "," << values()[i] << "\n";
+    }
+
+    csv_file.close();
+  }
+
+ private:
+  static const std::optional<double> Metric(const double value) {
+    if (std::isnan(value)) {
+      return std::nullopt;
+    }
+
+    return value;
+  }
+
+  void Unmap() {
+    if (data_) {
+      ::munmap(data_, size_);
+      data_ = nullptr;
+      size_ = 0;
+    }
+  }
+
+  void* data_;
+  std::size_t size_;
+};
+
+}  // namespace control
+
+#endif  // CONTROL_TRACE_H_
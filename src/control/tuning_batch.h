@@ -0,0 +1,361 @@
+#ifndef CONTROL_TUNING_BATCH_H_
+#define CONTROL_TUNING_BATCH_H_
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <latch>
+#include <mutex>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "control/scenario.h"
+#include "control/tuning_job.h"
+#include "ga/random.h"
+#include "ga/termination.h"
+#include "ga/work_pool.h"
+
+namespace control {
+
+// A job of a batch and the name its result is reported under.
+struct BatchJob {
+  std::string name;
+  TuningJob job;
+};
+
+struct BatchResult {
+  TuningResult result;
+  // The evaluation workers the job was given, and its wall time.
+  std::size_t num_workers = 0;
+  double seconds = 0.0;
+  // Why the job failed, empty if it did not.
+  std::string error;
+};
+
+// Reads one job per line as a name followed by KEY=VALUE fields, each of
+// which overrides `defaults`:
+//   plant=B0,B1,.../A0,A1,...  dead_time=SECONDS  epsilon=POLE
+//   kp=LOWER:UPPER  ti=LOWER:UPPER  td=LOWER:UPPER
+//   population=N  generations=N  crossover=PR  mutation=PR
+//   selection=fps|tournament|rank  seed=S  precision=double|float
+//   target_fitness=F  stall=K  max_evaluations=M  time_limit=SECONDS
+//   priority=P
+// `epsilon` sets the pole of the first order plant in every scenario, and is
+// an error for a job with a transfer function, from `plant` or `defaults`. A
+// job without its own seed runs with one derived from the seed of
+// `defaults`, if that is set, so that the whole batch is reproducible. Blank
+// lines and lines starting with '#' are skipped. A file without jobs is an
+// error.
+inline const std::vector<BatchJob> ReadTuningJobs(const std::string& file_name,
+                                                  const TuningJob& defaults) {
+  auto file = std::ifstream(file_name.c_str(), std::fstream::in);
+  if (!file) {
+    throw std::system_error(errno, std::generic_category(), file_name);
+  }
+
+  auto jobs = std::vector<BatchJob>();
+  auto line = std::string();
+  for (std::size_t line_number = 1; std::getline(file, line); ++line_number) {
+    auto first = line.find_first_not_of(" \t");
+    if (first == std::string::npos || line[first] == '#') {
+      continue;
+    }
+
+    auto malformed = [&file_name, line_number](const std::string& what) {
+      return std::runtime_error(file_name + ":" + std::to_string(line_number) +
+                                ": " + what);
+    };
+
+    auto fields = std::istringstream(line);
+    auto batch_job = BatchJob{std::string(), defaults};
+    auto& job = batch_job.job;
+    fields >> batch_job.name;
+    if (batch_job.name.find('=') != std::string::npos) {
+      throw malformed("job without a name");
+    }
+
+    auto has_seed = false;
+    auto has_epsilon = false;
+    for (auto field = std::string(); fields >> field;) {
+      auto separator = field.find('=');
+      if (separator == std::string::npos) {
+        throw malformed("expected KEY=VALUE, got " + field);
+      }
+
+      auto key = field.substr(0, separator);
+      auto value = field.substr(separator + 1);
+      auto bounds = [&value, &malformed, &key]() {
+        auto colon = value.find(':');
+        if (colon == std::string::npos) {
+          throw malformed(key + " needs LOWER:UPPER");
+        }
+        return TuningJob::Bounds(std::stod(value.substr(0, colon)),
+                                 std::stod(value.substr(colon + 1)));
+      };
+
+      try {
+        if (key == "plant") {
+          job.ParsePlant(value);
+        } else if (key == "dead_time") {
+          job.dead_time = std::stod(value);
+        } else if (key == "epsilon") {
+          for (auto& scenario : job.scenarios) {
+            scenario.plant_epsilon = std::stod(value);
+          }
+          has_epsilon = true;
+        } else if (key == "kp" || key == "ti" || key == "td") {
+          if (job.constraints.size() != Controller::kNumParams) {
+            throw malformed("no default bounds for " + key);
+          }
+          job.constraints[key == "kp" ? 0 : (key == "ti" ? 1 : 2)] = bounds();
+        } else if (key == "population") {
+          job.args.population_size = std::stoul(value);
+        } else if (key == "generations") {
+          job.args.num_generations = std::stoul(value);
+        } else if (key == "crossover") {
+          job.args.crossover_pr = std::stod(value);
+        } else if (key == "mutation") {
+          job.args.mutation_pr = std::stod(value);
+        } else if (key == "selection") {
+          if (value == "fps") {
+            job.args.selection =
+                TuningJob::Procedure::Selection::kFitnessProportionate;
+          } else if (value == "tournament") {
+            job.args.selection = TuningJob::Procedure::Selection::kTournament;
+          } else if (value == "rank") {
+            job.args.selection = TuningJob::Procedure::Selection::kRank;
+          } else {
+            throw malformed("bad value for " + key + ": " + value);
+          }
+        } else if (key == "seed") {
+          job.args.seed = std::stoull(value);
+          has_seed = true;
+        } else if (key == "precision") {
+          if (value == "double") {
+            job.precision = Precision::kDouble;
+          } else if (value == "float") {
+            job.precision = Precision::kFloat;
+          } else {
+            throw malformed("bad value for " + key + ": " + value);
+          }
+        } else if (key == "target_fitness") {
+          job.termination_rules.target_fitness = std::stod(value);
+        } else if (key == "stall") {
+          job.termination_rules.stall_generations = std::stoul(value);
+        } else if (key == "max_evaluations") {
+          job.termination_rules.max_evaluations = std::stoul(value);
+        } else if (key == "time_limit") {
+          job.termination_rules.time_limit =
+              std::chrono::duration<double>(std::stod(value));
+        } else if (key == "priority") {
+          job.priority = std::stoi(value);
+        } else {
+          throw malformed("unknown key " + key);
+        }
+      } catch (const std::logic_error&) {
+        throw malformed("bad value for " + key + ": " + value);
+      }
+    }
+
+    if (has_epsilon && job.plant_order() > 0) {
+      throw malformed("epsilon only applies without a plant");
+    }
+
+    if (!has_seed) {
+      job.args.seed = ga::DeriveSeed(defaults.args.seed, jobs.size());
+    }
+
+    jobs.push_back(std::move(batch_job));
+  }
+
+  if (jobs.empty()) {
+    throw std::runtime_error(file_name + ": no jobs");
+  }
+
+  return jobs;
+}
+
+// Runs a batch of jobs on one WorkPool of `num_threads` threads, the whole
+// parallelism budget, so that jobs and their evaluation workers never
+// oversubscribe the machine. The budget is split by a plan made up front
+// from each job's cost, its population times generations times scenarios:
+// with the ideal share of a thread being the total cost over the threads, a
+// job gets as many workers as it needs to fit that share, up to the batches
+// of a generation. Small jobs thus run on a single worker, packed side by
+// side without synchronization, and only the jobs that would otherwise
+// dominate the batch's wall time are split. Jobs start largest first, within
+// their own priorities, and the tasks of running jobs are stolen ahead of
+// starting smaller jobs, so the longest jobs never trail at the end.
+class TuningBatch {
+ public:
+  // Zero threads uses every hardware thread.
+  explicit TuningBatch(const std::vector<BatchJob>& jobs,
+                       const std::size_t num_threads = 0)
+      : jobs_(jobs), pool_(num_threads) {
+    Plan();
+  }
+
+  ~TuningBatch() = default;
+
+  const std::vector<BatchJob>& jobs() const { return jobs_; }
+  const std::size_t num_threads() const { return pool_.size(); }
+
+  // The planned evaluation workers of every job.
+  const std::vector<std::size_t>& num_workers() const { return num_workers_; }
+
+  // Runs every job and returns their results in the order of jobs(). A job
+  // that fails only fails its own result. `on_done(index, result)` is called
+  // as each job finishes, one call at a time.
+  const std::vector<BatchResult> Run(
+      const std::function<void(const std::size_t, const BatchResult&)>&
+          on_done = {}) {
+    auto results = std::vector<BatchResult>(jobs_.size());
+    auto mutex = std::mutex();
+    auto remaining = std::latch(static_cast<std::ptrdiff_t>(jobs_.size()));
+
+    for (std::size_t i = 0; i < jobs_.size(); ++i) {
+      pool_.Submit(
+          [this, i, &results, &mutex, &remaining, &on_done] {
+            auto job = jobs_[i].job;
+            job.args.num_workers = num_workers_[i];
+
+            auto& result = results[i];
+            result.num_workers = num_workers_[i];
+            auto start = std::chrono::steady_clock::now();
+            try {
+              result.result = job.Run(&pool_);
+            } catch (const std::exception& e) {
+              result.error = e.what();
+            }
+            result.seconds = std::chrono::duration<double>(
+                                 std::chrono::steady_clock::now() - start)
+                                 .count();
+
+            if (on_done) {
+              auto lock = std::lock_guard(mutex);
+              on_done(i, result);
+            }
+            remaining.count_down();
+          },
+          priorities_[i]);
+    }
+
+    remaining.wait();
+
+    return results;
+  }
+
+  // Writes one CSV line per job, in the order of jobs(): its name, solution,
+  // fitness, the rules that stopped it, seed, workers and wall time, and why
+  // it failed if it did.
+  static void WriteResults(const std::string& file_name,
+                           const std::vector<BatchJob>& jobs,
+                           const std::vector<BatchResult>& results) {
+    auto file = std::ofstream(file_name.c_str(), std::fstream::out);
+    if (!file) {
+      throw std::system_error(errno, std::generic_category(), file_name);
+    }
+
+    file << "name,k_p,t_i,t_d,fitness,stopped_by,seed,workers,seconds,error"
+         << std::endl;
+    for (std::size_t i = 0; i < jobs.size(); ++i) {
+      const auto& result = results[i];
+      file << Quote(jobs[i].name) << ",";
+      if (result.error.empty()) {
+        const auto& solution = result.result.solution;
+        file << solution[0].value() << "," << solution[1].value() << ","
+             << solution[2].value() << "," << solution.fitness() << ","
+             << ga::TerminationRules::Describe(result.result.termination_reason)
+             << "," << result.result.seed;
+      } else {
+        file << ",,,,,";
+      }
+      file << "," << result.num_workers << "," << result.seconds << ","
+           << Quote(result.error) << std::endl;
+    }
+
+    if (!file) {
+      throw std::system_error(errno, std::generic_category(), file_name);
+    }
+  }
+
+ private:
+  // A rough cost, in simulations, of running `job` to its generation limit.
+  static const double Cost(const TuningJob& job) {
+    return static_cast<double>(job.args.population_size) *
+           static_cast<double>(job.args.num_generations + 1) *
+           static_cast<double>(job.scenarios.size());
+  }
+
+  void Plan() {
+    auto size = jobs_.size();
+    auto costs = std::vector<double>(size);
+    for (std::size_t i = 0; i < size; ++i) {
+      costs[i] = Cost(jobs_[i].job);
+    }
+
+    auto num_threads = pool_.size();
+    auto share = std::accumulate(costs.begin(), costs.end(), 0.0) /
+                 static_cast<double>(num_threads);
+
+    num_workers_.resize(size);
+    for (std::size_t i = 0; i < size; ++i) {
+      auto needed = share > 0.0 ? std::ceil(costs[i] / share) : 1.0;
+      num_workers_[i] = std::clamp(static_cast<std::size_t>(needed),
+                                   std::size_t(1),
+                                   std::min(num_threads,
+                                            jobs_[i].job.num_batches()));
+    }
+
+    // Largest first within a priority; the pool runs higher values first.
+    auto order = std::vector<std::size_t>(size);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [this, &costs](const std::size_t i, const std::size_t j) {
+                       return jobs_[i].job.priority != jobs_[j].job.priority
+                                  ? jobs_[i].job.priority >
+                                        jobs_[j].job.priority
+                                  : costs[i] > costs[j];
+                     });
+
+    priorities_.resize(size);
+    for (std::size_t rank = 0; rank < size; ++rank) {
+      priorities_[order[rank]] = static_cast<int>(size - rank);
+    }
+  }
+
+  static const std::string Quote(const std::string& text) {
+    if (text.find_first_of(",\"\n") == std::string::npos) {
+      return text;
+    }
+
+    auto quoted = std::string("\"");
+    for (auto c : text) {
+      quoted += c == '"' ? std::string("\"\"") : std::string(1, c);
+    }
+
+    return quoted + "\"";
+  }
+
+  std::vector<BatchJob> jobs_;
+  std::vector<std::size_t> num_workers_;
+  std::vector<int> priorities_;
+
+  // Destroyed first, so that running jobs finish while the rest is intact.
+  ga::WorkPool pool_;
+};
+
+}  // namespace control
+
+#endif  // CONTROL_TUNING_BATCH_H_
@@ -0,0 +1,309 @@
+#ifndef CONTROL_TUNING_DAEMON_H_
+#define CONTROL_TUNING_DAEMON_H_
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "control/tuning_job.h"
+#include "ga/checkpoint.h"
+#include "ga/log_sink.h"
+#include "ga/wire.h"
+#include "ga/work_pool.h"
+
+namespace control {
+
+// Serves TuningJobs over a Unix domain socket, running them on one WorkPool
+// that stays warm between jobs. A client connects once per job and sends it
+// encoded as a kJob message. The daemon answers with a kProgress message
+// carrying the best fitness of every generation and then either a kResult
+// carrying the encoded TuningResult or a kError carrying a description.
+// Sending kStop, or closing the connection, cancels the job: a queued job is
+// dropped with a kError, and a running one stops after its current
+// generation and still sends its result.
+class TuningDaemon {
+ public:
+  static constexpr const int kBacklog = 64;
+
+  // How often Serve checks for Stop.
+  static constexpr const int kPollIntervalMs = 100;
+
+  // Zero threads uses every hardware thread.
+  TuningDaemon(const std::string& socket_path,
+               const std::size_t num_threads = 0)
+      : socket_path_(socket_path),
+        listener_(ga::wire::Listen(socket_path, kBacklog)),
+        stopping_(false),
+        pool_(num_threads) {}
+
+  // Cancels every job and waits for the running ones.
+  ~TuningDaemon() {
+    Stop();
+
+    auto lock = std::lock_guard(mutex_);
+    for (auto& connection : connections_) {
+      connection.thread.join();
+    }
+    ::unlink(socket_path_.c_str());
+  }
+
+  const ga::WorkPool& pool() const { return pool_; }
+
+  // Accepts connections until Stop.
+  void Serve() {
+    while (!stopping_.load()) {
+      if (!ga::wire::Readable(listener_, kPollIntervalMs)) {
+        continue;
+      }
+
+      auto session = std::make_shared<Session>(ga::wire::Accept(listener_));
+      auto lock = std::lock_guard(mutex_);
+      Reap();
+      auto& connection = connections_.emplace_back(session);
+      connection.thread = std::jthread([this, &connection] {
+        Handle(connection.session);
+        connection.done.store(true);
+      });
+      if (stopping_.load()) {
+        connection.Close();
+      }
+    }
+  }
+
+  // Makes Serve return and cancels every job. Safe to call from any thread.
+  void Stop() {
+    stopping_.store(true);
+
+    auto lock = std::lock_guard(mutex_);
+    for (auto& connection : connections_) {
+      connection.Close();
+    }
+  }
+
+ private:
+  enum class State : std::uint8_t { kQueued, kRunning, kCancelled };
+
+  // A job and the connection it came in on. Once the job leaves kQueued only
+  // its runner writes to the socket.
+  struct Session {
+    explicit Session(ga::wire::Socket socket)
+        : socket(std::move(socket)), state(State::kQueued) {}
+
+    // Drops a queued job, or stops a running one after its current
+    // generation.
+    void Cancel() {
+      auto queued = State::kQueued;
+      if (state.compare_exchange_strong(queued, State::kCancelled)) {
+        SendError(socket, "Cancelled before it started");
+        ::shutdown(socket.fd(), SHUT_RDWR);
+      }
+      stop.request_stop();
+    }
+
+    ga::wire::Socket socket;
+    std::atomic<State> state;
+    std::stop_source stop;
+  };
+
+  // Streams the best fitness of every generation to the client and stops the
+  // job once the client has gone away.
+  class ProgressSink : public ga::LogSink {
+   public:
+    explicit ProgressSink(Session& session) : session_(session) {}
+
+    void Write(const ga::LogRecord& record) final {
+      auto message = ga::wire::Message(ga::wire::Message::Type::kProgress, 0,
+                                       static_cast<std::uint32_t>(
+                                           record.generation));
+      message.payload.resize(sizeof(double));
+      std::memcpy(message.payload.data(), &record.fitness, sizeof(double));
+      if (!ga::wire::Send(session_.socket, message)) {
+        session_.stop.request_stop();
+      }
+    }
+
+   private:
+    Session& session_;
+  };
+
+  // A connection and its handler. The connection holds on to the session
+  // until it is reaped, so that its socket stays open for Close.
+  struct Connection {
+    explicit Connection(std::shared_ptr<Session> session)
+        : session(std::move(session)), done(false) {}
+
+    // Cancels the job and wakes the handler, but lets a running job still
+    // send its result.
+    void Close() {
+      session->Cancel();
+      ::shutdown(session->socket.fd(), SHUT_RD);
+    }
+
+    std::shared_ptr<Session> session;
+    std::jthread thread;
+    std::atomic<bool> done;
+  };
+
+  static void SendError(const ga::wire::Socket& socket,
+                        const std::string& what) {
+    auto message = ga::wire::Message(ga::wire::Message::Type::kError);
+    message.payload.assign(what.begin(), what.end());
+    ga::wire::Send(socket, message);
+  }
+
+  // A failing connection, e.g. one out of memory, only cancels its own job.
+  void Handle(const std::shared_ptr<Session>& session) {
+    try {
+      ServeConnection(session);
+    } catch (const std::exception&) {
+      session->Cancel();
+    }
+  }
+
+  // Reads the job, queues it and then waits for a cancellation or for the
+  // runner to close the connection.
+  void ServeConnection(const std::shared_ptr<Session>& session) {
+    auto message = ga::wire::Message();
+    if (!ga::wire::Receive(session->socket, message) ||
+        message.type != ga::wire::Message::Type::kJob) {
+      session->Cancel();
+      return;
+    }
+
+    auto job = TuningJob();
+    try {
+      auto decoder = ga::CheckpointDecoder(message.payload);
+      job.Restore(decoder);
+      job.Validate();
+    } catch (const std::exception& e) {
+      session->state.store(State::kCancelled);
+      SendError(session->socket, e.what());
+      return;
+    }
+
+    // Workers beyond the pool's threads would only queue behind each other.
+    if (job.args.num_workers == 0 || job.args.num_workers > pool_.size()) {
+      job.args.num_workers = pool_.size();
+    }
+
+    pool_.Submit([this, session, job] { RunJob(*session, job); },
+                 job.priority);
+
+    while (ga::wire::Receive(session->socket, message) &&
+           message.type != ga::wire::Message::Type::kStop) {
+    }
+    session->Cancel();
+  }
+
+  void RunJob(Session& session, const TuningJob& job) {
+    auto queued = State::kQueued;
+    if (!session.state.compare_exchange_strong(queued, State::kRunning)) {
+      return;
+    }
+
+    auto progress = ProgressSink(session);
+    try {
+      auto result = job.Run(&pool_, &progress, session.stop.get_token());
+
+      auto message = ga::wire::Message(ga::wire::Message::Type::kResult);
+      auto encoder = ga::CheckpointEncoder(message.payload);
+      result.Save(encoder);
+      ga::wire::Send(session.socket, message);
+    } catch (const std::exception& e) {
+      SendError(session.socket, e.what());
+    }
+
+    // Wakes the handler blocked reading from the client.
+    ::shutdown(session.socket.fd(), SHUT_RDWR);
+  }
+
+  // Forgets the connections whose handlers have returned. Needs `mutex_`.
+  void Reap() {
+    for (auto it = connections_.begin(); it != connections_.end();) {
+      if (it->done.load()) {
+        it->thread.join();
+        it = connections_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  std::string socket_path_;
+  ga::wire::Socket listener_;
+  std::atomic<bool> stopping_;
+
+  std::mutex mutex_;
+  std::list<Connection> connections_;
+
+  // Destroyed first, so that running jobs finish while the rest is intact.
+  ga::WorkPool pool_;
+};
+
+// Sends `job` to the daemon at `socket_path` and blocks until it is done,
+// calling `on_progress(generation, best_fitness)` for every generation. Once
+// `on_progress` returns false the job is cancelled. Throws
+// std::runtime_error with the daemon's description of a failed or dropped
+// job.
+inline const TuningResult SubmitTuningJob(
+    const std::string& socket_path, const TuningJob& job,
+    const std::function<bool(const std::uint32_t, const double)>&
+        on_progress = {}) {
+  auto socket = ga::wire::Connect(socket_path);
+
+  auto message = ga::wire::Message(ga::wire::Message::Type::kJob);
+  auto encoder = ga::CheckpointEncoder(message.payload);
+  job.Save(encoder);
+  if (!ga::wire::Send(socket, message)) {
+    throw std::runtime_error("Tuning daemon went away");
+  }
+
+  auto cancelled = false;
+  while (ga::wire::Receive(socket, message)) {
+    switch (message.type) {
+      case ga::wire::Message::Type::kProgress:
+        if (on_progress && !cancelled &&
+            message.payload.size() == sizeof(double)) {
+          double fitness;
+          std::memcpy(&fitness, message.payload.data(), sizeof(double));
+          if (!on_progress(message.generation, fitness)) {
+            cancelled = true;
+            ga::wire::Send(socket,
+                           ga::wire::Message(ga::wire::Message::Type::kStop));
+          }
+        }
+        break;
+      case ga::wire::Message::Type::kResult: {
+        auto result = TuningResult();
+        auto decoder = ga::CheckpointDecoder(message.payload);
+        result.Restore(decoder);
+        return result;
+      }
+      case ga::wire::Message::Type::kError:
+        throw std::runtime_error(
+            std::string(message.payload.begin(), message.payload.end()));
+      default:
+        break;
+    }
+  }
+
+  throw std::runtime_error("Tuning daemon went away");
+}
+
+}  // namespace control
+
+#endif  // CONTROL_TUNING_DAEMON_H_
@@ -0,0 +1,354 @@
+#ifndef CONTROL_TUNING_JOB_H_
+#define CONTROL_TUNING_JOB_H_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <vector>
+
+#include "control/controller.h"
+#include "control/plant.h"
+#include "control/scenario.h"
+#include "control/solver.h"
+#include "control/state_space_plant.h"
+#include "ga/checkpoint.h"
+#include "ga/log_sink.h"
+#include "ga/termination.h"
+#include "ga/work_pool.h"
+
+namespace control {
+
+// What a tuning job found: the solution, the TerminationRules::Rule bits that
+// stopped it and the seed it ran with.
+struct TuningResult {
+  using chromosome_type = ga::Chromosome<double, Controller::kNumParams>;
+
+  void Save(ga::CheckpointEncoder& encoder) const {
+    for (const auto& gene : solution) {
+      encoder.Put(gene.value());
+    }
+    encoder.Put(solution.fitness());
+    encoder.Put(static_cast<std::uint32_t>(termination_reason));
+    encoder.Put(seed);
+  }
+
+  void Restore(ga::CheckpointDecoder& decoder) {
+    for (auto& gene : solution) {
+      gene.value() = decoder.Get<double>();
+    }
+    solution.fitness() = decoder.Get<double>();
+    termination_reason = decoder.Get<std::uint32_t>();
+    seed = decoder.Get<std::uint64_t>();
+  }
+
+  chromosome_type solution;
+  unsigned termination_reason = 0;
+  std::uint64_t seed = 0;
+};
+
+// A self-contained request to tune a PID controller: the arguments and
+// constraints of the search, the scenarios and the plant. The plant is a
+// transfer function of up to kMaxPlantOrder with a dead time, simulated as a
+// StateSpacePlant, or without coefficients the first order StaticPlant whose
+// pole every scenario sets. Jobs encode to a compact binary request with the
+// checkpoint encoder.
+struct TuningJob {
+  using Procedure = ga::Procedure<double, Controller::kNumParams>;
+  using Args = Procedure::Args;
+  using Bounds = ga::Gene<double>::Bounds;
+
+  static constexpr const std::uint32_t kVersion = 1;
+  static constexpr const std::size_t kMaxPlantOrder = 4;
+  // Dead times of up to this many samples fit the plant's delay line.
+  static constexpr const std::size_t kMaxDeadTimeSamples = 512;
+
+  // Larger jobs are rejected, so that a single request cannot exhaust the
+  // memory of the daemon or hold its threads indefinitely.
+  static constexpr const std::size_t kMaxPopulationSize = 1 << 16;
+  static constexpr const std::size_t kMaxGenerations = 1 << 20;
+  static constexpr const std::size_t kMaxScenarios = 256;
+  static constexpr const std::size_t kMaxCacheCapacity = 1 << 20;
+
+  // The order of the plant's transfer function, zero for StaticPlant.
+  const std::size_t plant_order() const {
+    return denominator.empty() ? 0 : denominator.size() - 1;
+  }
+
+  // Throws std::invalid_argument describing the first problem of a job that
+  // cannot run.
+  void Validate() const {
+    if (args.population_size < 2 || args.population_size > kMaxPopulationSize) {
+      throw std::invalid_argument("Population must hold two to " +
+                                  std::to_string(kMaxPopulationSize));
+    }
+    if (args.num_generations > kMaxGenerations) {
+      throw std::invalid_argument("At most " +
+                                  std::to_string(kMaxGenerations) +
+                                  " generations");
+    }
+    if (args.cache_capacity > kMaxCacheCapacity) {
+      throw std::invalid_argument("Cache holds at most " +
+                                  std::to_string(kMaxCacheCapacity) +
+                                  " chromosomes");
+    }
+    if (!(args.cache_quantum >= 0.0)) {
+      throw std::invalid_argument("Cache quantum must be zero or positive");
+    }
+    if (args.tournament_size < 1 ||
+        args.tournament_size > args.population_size) {
+      throw std::invalid_argument("Tournament must hold one to the population");
+    }
+    for (const auto fraction :
+         {args.crossover_pr, args.mutation_pr, args.screening_fraction,
+          args.surrogate_fraction}) {
+      if (!(fraction >= 0.0 && fraction <= 1.0)) {
+        throw std::invalid_argument(
+            "Probabilities and fractions must lie in [0, 1]");
+      }
+    }
+    if (args.selection > Procedure::Selection::kRank ||
+        aggregate > Aggregate::kWeighted || precision > Precision::kFloat ||
+        termination_rules.mode > ga::TerminationRules::Mode::kAll) {
+      throw std::invalid_argument(
+          "Unknown selection, aggregate, precision or stopping mode");
+    }
+    if (constraints.size() != Controller::kNumParams) {
+      throw std::invalid_argument("Expected bounds for every PID parameter");
+    }
+    for (const auto& bounds : constraints) {
+      if (!(bounds.lower <= bounds.upper)) {
+        throw std::invalid_argument("Lower bound above upper bound");
+      }
+    }
+    if (scenarios.empty() || scenarios.size() > kMaxScenarios) {
+      throw std::invalid_argument("Expected one to " +
+                                  std::to_string(kMaxScenarios) +
+                                  " scenarios");
+    }
+    for (const auto& scenario : scenarios) {
+      if (scenario.setpoint == 0.0 || !(scenario.weight > 0.0)) {
+        throw std::invalid_argument("Scenario without set point or weight");
+      }
+    }
+    if (numerator.size() != denominator.size() ||
+        (!denominator.empty() &&
+         (plant_order() < 1 || plant_order() > kMaxPlantOrder))) {
+      throw std::invalid_argument(
+          "Plant needs as many numerator as denominator coefficients, of "
+          "order 1 to " +
+          std::to_string(kMaxPlantOrder));
+    }
+    if (!(dead_time >= 0.0) || (plant_order() == 0 && dead_time != 0.0)) {
+      throw std::invalid_argument("Dead time needs a transfer function");
+    }
+  }
+
+  // Tunes the controller, evaluating on `executor` if it is set and
+  // reporting every generation's best fitness to `progress` if it is set. A
+  // stop requested through `stop` finishes the run after the current
+  // generation. Throws std::invalid_argument for a job that cannot run.
+  const TuningResult Run(ga::Executor* executor = nullptr,
+                         ga::LogSink* progress = nullptr,
+                         const std::stop_token& stop = {}) const {
+    Validate();
+    switch (plant_order()) {
+      case 1:
+        return Run(MakePlant<1>(), executor, progress, stop);
+      case 2:
+        return Run(MakePlant<2>(), executor, progress, stop);
+      case 3:
+        return Run(MakePlant<3>(), executor, progress, stop);
+      case 4:
+        return Run(MakePlant<4>(), executor, progress, stop);
+      default:
+        return Run(StaticPlant<>(), executor, progress, stop);
+    }
+  }
+
+  // Sets the plant's transfer function from "B0 B1 ... / A0 A1 ...", the
+  // coefficients of its numerator and denominator in descending powers of s,
+  // separated by spaces or commas. A shorter numerator is padded with leading
+  // zeros.
+  void ParsePlant(std::string text) {
+    std::replace(text.begin(), text.end(), ',', ' ');
+    auto separator = text.find('/');
+    if (separator == std::string::npos) {
+      throw std::invalid_argument("Transfer function without '/': " + text);
+    }
+
+    auto parse = [&text](const std::string& part, std::vector<double>& values) {
+      auto fields = std::istringstream(part);
+      values.clear();
+      for (double value; fields >> value;) {
+        values.push_back(value);
+      }
+      if (!fields.eof()) {
+        throw std::invalid_argument("Malformed transfer function: " + text);
+      }
+    };
+
+    parse(text.substr(0, separator), numerator);
+    parse(text.substr(separator + 1), denominator);
+    if (numerator.size() < denominator.size()) {
+      numerator.insert(numerator.begin(),
+                       denominator.size() - numerator.size(), 0.0);
+    }
+  }
+
+  // The evaluation batches of a generation's offspring, see
+  // Solver::batch_size: the most workers the job keeps busy.
+  const std::size_t num_batches() const {
+    auto num_lanes = precision == Precision::kFloat
+                         ? Solver<>::kFloatBatchSize
+                         : Solver<>::kBatchSize;
+    auto batch_size =
+        std::max(std::size_t(1), num_lanes / std::max(std::size_t(1),
+                                                      scenarios.size()));
+
+    return std::max(std::size_t(1),
+                    (args.population_size + batch_size - 1) / batch_size);
+  }
+
+  void Save(ga::CheckpointEncoder& encoder) const {
+    encoder.PutBytes("GAJB", 4);
+    encoder.Put(kVersion);
+    encoder.Put(priority);
+    args.Save(encoder);
+
+    encoder.Put(static_cast<std::uint64_t>(constraints.size()));
+    for (const auto& bounds : constraints) {
+      encoder.Put(bounds.lower);
+      encoder.Put(bounds.upper);
+    }
+
+    encoder.Put(static_cast<std::uint64_t>(scenarios.size()));
+    for (const auto& scenario : scenarios) {
+      encoder.Put(scenario.setpoint);
+      encoder.Put(scenario.plant_epsilon);
+      encoder.Put(scenario.disturbance.load);
+      encoder.Put(scenario.disturbance.time);
+      encoder.Put(scenario.weight);
+    }
+
+    encoder.Put(aggregate);
+    encoder.Put(precision);
+    encoder.Put(static_cast<std::uint64_t>(num_verified_elites));
+    termination_rules.Save(encoder);
+
+    encoder.PutArray(numerator.data(), numerator.size());
+    encoder.PutArray(denominator.data(), denominator.size());
+    encoder.Put(dead_time);
+  }
+
+  // Throws std::runtime_error for a request of another version or one that
+  // ends early. The values themselves are only checked by Validate.
+  void Restore(ga::CheckpointDecoder& decoder) {
+    char magic[4];
+    decoder.GetBytes(magic, sizeof(magic));
+    if (std::memcmp(magic, "GAJB", sizeof(magic)) != 0 ||
+        decoder.Get<std::uint32_t>() != kVersion) {
+      throw std::runtime_error("Incompatible tuning job");
+    }
+
+    priority = decoder.Get<std::int32_t>();
+    args.Restore(decoder);
+
+    constraints.clear();
+    for (auto i = decoder.Get<std::uint64_t>(); i > 0; --i) {
+      auto lower = decoder.Get<double>();
+      auto upper = decoder.Get<double>();
+      constraints.push_back(Bounds(lower, upper));
+    }
+
+    scenarios.clear();
+    for (auto i = decoder.Get<std::uint64_t>(); i > 0; --i) {
+      auto scenario = Scenario();
+      scenario.setpoint = decoder.Get<double>();
+      scenario.plant_epsilon = decoder.Get<double>();
+      scenario.disturbance.load = decoder.Get<double>();
+      scenario.disturbance.time = decoder.Get<double>();
+      scenario.weight = decoder.Get<double>();
+      scenarios.push_back(scenario);
+    }
+
+    aggregate = decoder.Get<Aggregate>();
+    precision = decoder.Get<Precision>();
+    num_verified_elites = decoder.Get<std::uint64_t>();
+    termination_rules.Restore(decoder);
+
+    numerator = decoder.GetArray<double>();
+    denominator = decoder.GetArray<double>();
+    dead_time = decoder.Get<double>();
+  }
+
+  // Queued jobs of higher priority start first.
+  std::int32_t priority = 0;
+
+  Args args;
+  std::vector<Bounds> constraints;
+  std::vector<Scenario> scenarios = std::vector<Scenario>(1);
+  Aggregate aggregate = Aggregate::kMean;
+  Precision precision = Precision::kDouble;
+  std::size_t num_verified_elites = 0;
+  ga::TerminationRules termination_rules;
+
+  // The plant's transfer function in descending powers of s.
+  std::vector<double> numerator;
+  std::vector<double> denominator;
+  double dead_time = 0.0;
+
+ private:
+  template <std::size_t Order>
+  const StateSpacePlant<Order, kMaxDeadTimeSamples> MakePlant() const {
+    auto num = std::array<double, Order + 1>();
+    auto den = std::array<double, Order + 1>();
+    std::copy(numerator.begin(), numerator.end(), num.begin());
+    std::copy(denominator.begin(), denominator.end(), den.begin());
+
+    auto plant = StateSpacePlant<Order, kMaxDeadTimeSamples>(
+        StateSpace<Order>::FromTransferFunction(num, den), dead_time);
+
+    // Fails now rather than on the first simulation.
+    plant.model().Discretize(System::kSampleTimeSecs);
+    plant.DelaySamples(dead_time, System::kSampleTimeSecs);
+
+    return plant;
+  }
+
+  template <typename P>
+  const TuningResult Run(const P& plant, ga::Executor* executor,
+                         ga::LogSink* progress,
+                         const std::stop_token& stop) const {
+    auto solver = Solver<double, Controller::kNumParams, P>(args, constraints);
+    solver.log_file_name().clear();
+    solver.set_log_sink(progress);
+    solver.set_executor(executor);
+    solver.termination_rules() = termination_rules;
+    solver.scenarios() = scenarios;
+    solver.aggregate() = aggregate;
+    solver.precision() = precision;
+    solver.num_verified_elites() = num_verified_elites;
+    solver.plant() = plant;
+
+    // Runs at once if the stop was requested before the run started.
+    auto stop_callback =
+        std::stop_callback(stop, [&solver] { solver.RequestStop(); });
+
+    auto result = TuningResult();
+    result.solution = solver.Start();
+    result.termination_reason = solver.termination_reason();
+    result.seed = solver.args().seed;
+
+    return result;
+  }
+};
+
+}  // namespace control
+
+#endif  // CONTROL_TUNING_JOB_H_
@@ -0,0 +1,82 @@
+#ifndef GA_ALIAS_TABLE_H_
+#define GA_ALIAS_TABLE_H_
+
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+namespace ga {
+
+// Walker's alias method, built with Vose's algorithm: after an O(n) build
+// from non-negative weights it draws an index with probability proportional
+// to its weight in O(1). Storage is kept between builds, so rebuilding a
+// table of the same size does not allocate.
+class AliasTable {
+ public:
+  AliasTable() = default;
+  ~AliasTable() = default;
+
+  constexpr const std::size_t size() const { return probabilities_.size(); }
+
+  // Weights that sum to zero or are not finite are treated as uniform.
+  void Build(const std::vector<double>& weights) {
+    auto size = weights.size();
+    probabilities_.resize(size);
+    aliases_.resize(size);
+    small_.clear();
+    large_.clear();
+
+    double sum = 0.0;
+    for (auto weight : weights) {
+      sum += weight;
+    }
+
+    auto uniform = !(sum > 0.0) || !std::isfinite(sum);
+    for (std::size_t i = 0; i < size; ++i) {
+      probabilities_[i] = uniform ? 1.0 : weights[i] * size / sum;
+      aliases_[i] = i;
+      (probabilities_[i] < 1.0 ? small_ : large_).push_back(i);
+    }
+
+    while (!small_.empty() && !large_.empty()) {
+      auto small = small_.back();
+      auto large = large_.back();
+      small_.pop_back();
+      large_.pop_back();
+
+      aliases_[small] = large;
+      probabilities_[large] += probabilities_[small] - 1.0;
+      (probabilities_[large] < 1.0 ? small_ : large_).push_back(large);
+    }
+
+    // Whatever is left over only differs from one by rounding.
+    for (auto i : small_) {
+      probabilities_[i] = 1.0;
+    }
+    for (auto i : large_) {
+      probabilities_[i] = 1.0;
+    }
+  }
+
+  template <typename Generator>
+  const std::size_t Sample(Generator& generator) const {
+    auto column = std::uniform_int_distribution<std::size_t>(
+        0, probabilities_.size() - 1)(generator);
+    auto coin = std::uniform_real_distribution<>()(generator);
+
+    return coin < probabilities_[column] ? column : aliases_[column];
+  }
+
+ private:
+  std::vector<double> probabilities_;
+  std::vector<std::size_t> aliases_;
+
+  // Work lists of the build.
+  std::vector<std::size_t> small_;
+  std::vector<std::size_t> large_;
+};
+
+}  // namespace ga
+
+#endif  // GA_ALIAS_TABLE_H_
@@ -0,0 +1,274 @@
+#ifndef GA_CHECKPOINT_H_
+#define GA_CHECKPOINT_H_
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace ga {
+
+// Appends values to a checkpoint buffer in host byte order.
+class CheckpointEncoder {
+ public:
+  explicit CheckpointEncoder(std::vector<std::uint8_t>& buffer)
+      : buffer_(buffer) {
+    buffer_.clear();
+  }
+
+  ~CheckpointEncoder() = default;
+
+  template <typename V>
+  void Put(const V& value) {
+    static_assert(std::is_trivially_copyable<V>::value,
+                  "Only trivially copyable values can be encoded");
+    PutBytes(&value, sizeof(V));
+  }
+
+  // A count followed by the values.
+  template <typename V>
+  void PutArray(const V* values, const std::size_t count) {
+    static_assert(std::is_trivially_copyable<V>::value,
+                  "Only trivially copyable values can be encoded");
+    Put(static_cast<std::uint64_t>(count));
+    PutBytes(values, count * sizeof(V));
+  }
+
+  void PutBytes(const void* data, const std::size_t size) {
+    auto bytes = static_cast<const std::uint8_t*>(data);
+    buffer_.insert(buffer_.end(), bytes, bytes + size);
+  }
+
+ private:
+  std::vector<std::uint8_t>& buffer_;
+};
+
+// Reads back what a CheckpointEncoder wrote. Reading past the end throws.
+class CheckpointDecoder {
+ public:
+  CheckpointDecoder(const std::uint8_t* data, const std::size_t size)
+      : data_(data), size_(size), offset_(0) {}
+
+  explicit CheckpointDecoder(const std::vector<std::uint8_t>& buffer)
+      : CheckpointDecoder(buffer.data(), buffer.size()) {}
+
+  ~CheckpointDecoder() = default;
+
+  template <typename V>
+  const V Get() {
+    static_assert(std::is_trivially_copyable<V>::value,
+                  "Only trivially copyable values can be decoded");
+    V value;
+    GetBytes(&value, sizeof(V));
+
+    return value;
+  }
+
+  template <typename V>
+  const std::vector<V> GetArray() {
+    auto count = Get<std::uint64_t>();
+    if (count > (size_ - offset_) / sizeof(V)) {
+      throw std::runtime_error("Truncated checkpoint");
+    }
+
+    auto values = std::vector<V>(count);
+    GetBytes(values.data(), count * sizeof(V));
+
+    return values;
+  }
+
+  void GetBytes(void* data, const std::size_t size) {
+    if (size > size_ - offset_) {
+      throw std::runtime_error("Truncated checkpoint");
+    }
+
+    std::memcpy(data, data_ + offset_, size);
+    offset_ += size;
+  }
+
+ private:
+  const std::uint8_t* data_;
+  std::size_t size_;
+  std::size_t offset_;
+};
+
+// Writes checkpoints to a file on a background thread. The caller encodes a
+// checkpoint into its own buffer and trades it for the writer's idle one, so
+// encoding the next checkpoint never waits for the file system. Each file is
+// written next to the target, synced and renamed over it, and the directory
+// is synced too, so a crash mid-write leaves the previous checkpoint intact. A
+// checkpoint that could not be written is reported by the next call to
+// TryWrite or Wait.
+class CheckpointWriter {
+ public:
+  explicit CheckpointWriter(const std::string& file_name)
+      : file_name_(file_name), busy_(false) {
+    writer_ = std::jthread([this](std::stop_token stop) { Run(stop); });
+  }
+
+  // Finishes the checkpoint being written; a failure is dropped.
+  ~CheckpointWriter() {
+    auto lock = std::unique_lock(mutex_);
+    done_.wait(lock, [this]() { return !busy_; });
+  }
+
+  // Swaps `buffer` with the writer's idle buffer and starts writing it.
+  // Returns false, leaving `buffer` as it is, while the previous checkpoint
+  // is still being written. Throws std::system_error if the previous
+  // checkpoint failed.
+  const bool TryWrite(std::vector<std::uint8_t>& buffer) {
+    auto lock = std::lock_guard(mutex_);
+    if (busy_) {
+      return false;
+    }
+    RethrowError();
+
+    buffer_.swap(buffer);
+    busy_ = true;
+    work_.notify_one();
+
+    return true;
+  }
+
+  // Blocks until no checkpoint is being written. Throws std::system_error if
+  // the last checkpoint failed.
+  void Wait() {
+    auto lock = std::unique_lock(mutex_);
+    done_.wait(lock, [this]() { return !busy_; });
+    RethrowError();
+  }
+
+ private:
+  void Run(std::stop_token stop) {
+    auto lock = std::unique_lock(mutex_);
+    while (work_.wait(lock, stop, [this]() { return busy_; })) {
+      lock.unlock();
+      auto error = std::exception_ptr();
+      try {
+        WriteFile();
+      } catch (const std::system_error&) {
+        error = std::current_exception();
+      }
+      lock.lock();
+
+      error_ = error;
+      busy_ = false;
+      done_.notify_all();
+    }
+  }
+
+  // Needs `mutex_`.
+  void RethrowError() {
+    if (error_) {
+      auto error = error_;
+      error_ = nullptr;
+      std::rethrow_exception(error);
+    }
+  }
+
+  void WriteFile() const {
+    auto temp_file_name = file_name_ + ".tmp";
+    auto fd = ::open(temp_file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC,
+                     0644);
+    if (fd < 0) {
+      throw std::system_error(errno, std::generic_category(), temp_file_name);
+    }
+
+    auto fail = [fd, &temp_file_name]() {
+      auto error = errno;
+      ::close(fd);
+      ::unlink(temp_file_name.c_str());
+      return std::system_error(error, std::generic_category(),
+                               temp_file_name);
+    };
+
+    const auto* data = reinterpret_cast<const char*>(buffer_.data());
+    for (std::size_t size = buffer_.size(); size > 0;) {
+      auto written = ::write(fd, data, size);
+      if (written < 0 && errno == EINTR) {
+        continue;
+      } else if (written < 0) {
+        throw fail();
+      }
+
+      data += written;
+      size -= static_cast<std::size_t>(written);
+    }
+
+    if (::fsync(fd) != 0) {
+      throw fail();
+    }
+    if (::close(fd) != 0) {
+      auto error = errno;
+      ::unlink(temp_file_name.c_str());
+      throw std::system_error(error, std::generic_category(), temp_file_name);
+    }
+
+    if (std::rename(temp_file_name.c_str(), file_name_.c_str()) != 0) {
+      auto error = errno;
+      ::unlink(temp_file_name.c_str());
+      throw std::system_error(error, std::generic_category(), file_name_);
+    }
+
+    // Makes the rename itself durable.
+    auto separator = file_name_.find_last_of('/');
+    auto directory = separator == std::string::npos
+                         ? std::string(".")
+                         : file_name_.substr(0, std::max<std::size_t>(
+                                                    separator, 1));
+    auto directory_fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (directory_fd < 0) {
+      throw std::system_error(errno, std::generic_category(), directory);
+    }
+    auto synced = ::fsync(directory_fd) == 0;
+    auto error = errno;
+    ::close(directory_fd);
+    if (!synced) {
+      throw std::system_error(error, std::generic_category(), directory);
+    }
+  }
+
+  std::string file_name_;
+
+  std::mutex mutex_;
+  std::condition_variable_any work_;
+  std::condition_variable_any done_;
+  std::vector<std::uint8_t> buffer_;
+  bool busy_;
+  std::exception_ptr error_;
+
+  // Declared last so that it is joined before the members it uses go away.
+  std::jthread writer_;
+};
+
+inline const std::vector<std::uint8_t> ReadCheckpoint(
+    const std::string& file_name) {
+  auto file = std::ifstream(file_name.c_str(),
+                            std::fstream::in | std::fstream::binary);
+  if (!file) {
+    throw std::system_error(errno, std::generic_category(), file_name);
+  }
+
+  return std::vector<std::uint8_t>(std::istreambuf_iterator<char>(file),
+                                   std::istreambuf_iterator<char>());
+}
+
+}  // namespace ga
+
+#endif  // GA_CHECKPOINT_H_
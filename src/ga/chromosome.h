@@ -2,6 +2,7 @@
 #define GA_CHROMOSOME_H_
 
 #include <algorithm>
+#include <array>
 #include <cstddef>
 #include <iostream>
 #include <string>
@@ -18,18 +19,16 @@ class Chromosome;
 template <typename T, std::size_t N>
 std::ostream& operator<<(std::ostream& os, const Chromosome<T, N>& chromosome);
 
+// A fixed-size chromosome whose genes are stored inline, so copying one never
+// allocates. The gene bounds are owned by the population and passed to the
+// operations that need them.
 template <typename T, std::size_t N>
 class Chromosome {
  public:
-  constexpr Chromosome()
-      : genes_(std::vector<Gene<T>>(N)), fitness_(0.0), selection_pr_(0.0) {}
+  using iterator = typename std::array<Gene<T>, N>::iterator;
+  using const_iterator = typename std::array<Gene<T>, N>::const_iterator;
 
-  constexpr Chromosome(const std::vector<typename Gene<T>::Bounds>& bounds)
-      : Chromosome() {
-    for (std::size_t i = 0, size = std::min(N, bounds.size()); i < size; ++i) {
-      genes_[i] = Gene<T>(bounds[i]);
-    }
-  }
+  constexpr Chromosome() : genes_(), fitness_(0.0), selection_pr_(0.0) {}
 
   constexpr Chromosome(const Chromosome& chromosome)
       : genes_(chromosome.genes_),
@@ -38,7 +37,9 @@ class Chromosome {
 
   virtual constexpr ~Chromosome() = default;
 
-  constexpr const std::size_t size() const { return genes_.size(); }
+  constexpr Chromosome& operator=(const Chromosome& chromosome) = default;
+
+  constexpr const std::size_t size() const { return N; }
 
   constexpr const Gene<T>& operator[](const std::size_t i) const {
     return genes_[i];
@@ -48,22 +49,14 @@ class Chromosome {
   constexpr const Gene<T>& front() const { return genes_.front(); }
   constexpr Gene<T>& front() { return genes_.front(); }
 
-  constexpr const typename std::vector<Gene<T>>::iterator begin() const {
-    return genes_.begin();
-  }
-  constexpr typename std::vector<Gene<T>>::iterator begin() {
-    return genes_.begin();
-  }
+  constexpr const_iterator begin() const { return genes_.begin(); }
+  constexpr iterator begin() { return genes_.begin(); }
 
   constexpr const Gene<T>& back() const { return genes_.back(); }
   constexpr Gene<T>& back() { return genes_.back(); }
 
-  constexpr const typename std::vector<Gene<T>>::iterator end() const {
-    return genes_.end();
-  }
-  constexpr typename std::vector<Gene<T>>::iterator end() {
-    return genes_.end();
-  }
+  constexpr const_iterator end() const { return genes_.end(); }
+  constexpr iterator end() { return genes_.end(); }
 
   constexpr const double fitness() const { return fitness_; }
   constexpr double& fitness() { return fitness_; }
@@ -80,20 +73,35 @@ class Chromosome {
     selection_pr_ = 0.0;
   }
 
-  void randomize() {
-    for (auto& gene : genes_) {
-      gene.randomize();
+  // Draws every gene uniformly from its bounds with `generator`. Genes
+  // beyond the end of `bounds` use the default range of their distribution.
+  template <typename Generator>
+  void randomize(Generator& generator,
+                 const std::vector<typename Gene<T>::Bounds>& bounds = {}) {
+    for (std::size_t i = 0; i < N; ++i) {
+      if (i < bounds.size()) {
+        genes_[i].randomize(bounds[i], generator);
+      } else {
+        genes_[i].randomize(generator);
+      }
     }
 
     fitness_ = 0.0;
     selection_pr_ = 0.0;
   }
 
+  constexpr void validate(
+      const std::vector<typename Gene<T>::Bounds>& bounds) {
+    for (std::size_t i = 0, size = std::min(N, bounds.size()); i < size; ++i) {
+      genes_[i].validate(bounds[i]);
+    }
+  }
+
   friend std::ostream& operator<<<>(std::ostream& os,
                                     const Chromosome<T, N>& chromosome);
 
  private:
-  std::vector<Gene<T>> genes_;
+  std::array<Gene<T>, N> genes_;
   double fitness_;
   double selection_pr_;
 };
@@ -104,7 +112,7 @@ std::ostream& operator<<(std::ostream& os, const Chromosome<T, N>& chromosome) {
   os << "<";
 
   for (const auto& gene : chromosome.genes_) {
-    std::cout << seperator << gene;
+    os << seperator << gene;
     seperator = ", ";
   }
 
@@ -0,0 +1,272 @@
+#ifndef GA_FITNESS_CACHE_H_
+#define GA_FITNESS_CACHE_H_
+
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "ga/checkpoint.h"
+#include "ga/chromosome.h"
+
+namespace ga {
+
+// Bounded memo of chromosome fitnesses, keyed on gene values. Values may be
+// quantized so that near-identical chromosomes share an entry. Entries are
+// kept in a set-associative table whose storage is allocated once; a full set
+// evicts its least recently used entry.
+template <typename T, std::size_t N>
+class FitnessCache {
+ public:
+  static constexpr const std::size_t kNumWays = 4;
+  static constexpr const std::size_t kNotPending =
+      std::numeric_limits<std::size_t>::max();
+
+  struct Lookup {
+    enum class Status { kHit, kPending, kMiss };
+
+    constexpr Lookup(const Status status = Status::kMiss,
+                     const double fitness = 0.0,
+                     const std::size_t pending = kNotPending)
+        : status(status), fitness(fitness), pending(pending) {}
+
+    constexpr ~Lookup() = default;
+
+    Status status;
+    double fitness;
+    std::size_t pending;
+  };
+
+  // A capacity of zero disables the cache; a quantum of zero only matches
+  // identical gene values.
+  FitnessCache(const std::size_t capacity = 0, const double quantum = 0.0)
+      : quantum_(quantum),
+        num_sets_(NumSets(capacity)),
+        entries_(num_sets_ * kNumWays),
+        clock_(0),
+        hits_(0),
+        misses_(0),
+        evictions_(0) {}
+
+  ~FitnessCache() = default;
+
+  constexpr const bool enabled() const { return num_sets_ != 0; }
+  constexpr const std::size_t capacity() const { return entries_.size(); }
+
+  constexpr const std::size_t hits() const { return hits_; }
+  constexpr const std::size_t misses() const { return misses_; }
+  constexpr const std::size_t evictions() const { return evictions_; }
+
+  // Looks up `chromosome` for an evaluation bounded by `cost_bound`. A cached
+  // fitness that was only a lower bound is reused while it still exceeds
+  // `cost_bound`. A miss reserves an entry that refers to `pending`, the
+  // caller's index of the evaluation that will resolve it, so that duplicates
+  // within one generation are recognised before their fitness is known.
+  const Lookup Find(const Chromosome<T, N>& chromosome, const double cost_bound,
+                    const std::size_t pending) {
+    auto key = MakeKey(chromosome);
+    auto* entry = FindEntry(key);
+
+    if (entry) {
+      entry->last_used = ++clock_;
+      if (entry->pending != kNotPending) {
+        ++hits_;
+        return Lookup(Lookup::Status::kPending, 0.0, entry->pending);
+      } else if (entry->exact || entry->fitness > cost_bound) {
+        ++hits_;
+        return Lookup(Lookup::Status::kHit, entry->fitness);
+      }
+    } else {
+      entry = &InsertEntry(key);
+    }
+
+    ++misses_;
+    entry->pending = pending;
+    return Lookup(Lookup::Status::kMiss);
+  }
+
+  // Records the fitness of an evaluation bounded by `cost_bound` and resolves
+  // its pending entry.
+  void Store(const Chromosome<T, N>& chromosome, const double fitness,
+             const double cost_bound) {
+    auto key = MakeKey(chromosome);
+    auto* entry = FindEntry(key);
+    if (!entry) {
+      entry = &InsertEntry(key);
+    }
+
+    entry->fitness = fitness;
+    entry->exact = fitness <= cost_bound;
+    entry->pending = kNotPending;
+  }
+
+  // Records an estimate of the fitness, such as a screening score, and
+  // resolves its pending entry. Like a lower bound, it is only reused while it
+  // exceeds the cost bound.
+  void StoreEstimate(const Chromosome<T, N>& chromosome,
+                     const double fitness) {
+    Store(chromosome, fitness, -std::numeric_limits<double>::infinity());
+  }
+
+  // Saves the whole table, including its recency order and statistics, so
+  // that a resumed run sees exactly the same hits.
+  void Save(CheckpointEncoder& encoder) const {
+    encoder.Put(quantum_);
+    encoder.Put(static_cast<std::uint64_t>(num_sets_));
+    encoder.Put(static_cast<std::uint64_t>(entries_.size()));
+    for (const auto& entry : entries_) {
+      encoder.Put(entry.key);
+      encoder.Put(entry.fitness);
+      encoder.Put(entry.last_used);
+      encoder.Put(static_cast<std::uint64_t>(entry.pending));
+      encoder.Put(static_cast<std::uint8_t>(entry.exact));
+      encoder.Put(static_cast<std::uint8_t>(entry.valid));
+    }
+    encoder.Put(clock_);
+    encoder.Put(static_cast<std::uint64_t>(hits_));
+    encoder.Put(static_cast<std::uint64_t>(misses_));
+    encoder.Put(static_cast<std::uint64_t>(evictions_));
+  }
+
+  void Restore(CheckpointDecoder& decoder) {
+    quantum_ = decoder.Get<double>();
+    num_sets_ = decoder.Get<std::uint64_t>();
+    entries_.clear();
+    for (auto i = decoder.Get<std::uint64_t>(); i > 0; --i) {
+      auto entry = Entry();
+      entry.key = decoder.Get<Key>();
+      entry.fitness = decoder.Get<double>();
+      entry.last_used = decoder.Get<std::uint64_t>();
+      entry.pending = decoder.Get<std::uint64_t>();
+      entry.exact = decoder.Get<std::uint8_t>() != 0;
+      entry.valid = decoder.Get<std::uint8_t>() != 0;
+      entries_.push_back(entry);
+    }
+    if (entries_.size() != num_sets_ * kNumWays) {
+      throw std::runtime_error("Corrupt fitness cache in checkpoint");
+    }
+
+    clock_ = decoder.Get<std::uint64_t>();
+    hits_ = decoder.Get<std::uint64_t>();
+    misses_ = decoder.Get<std::uint64_t>();
+    evictions_ = decoder.Get<std::uint64_t>();
+  }
+
+  void clear() {
+    for (auto& entry : entries_) {
+      entry = Entry();
+    }
+
+    clock_ = 0;
+    hits_ = 0;
+    misses_ = 0;
+    evictions_ = 0;
+  }
+
+ private:
+  using Key = std::array<std::uint64_t, N>;
+
+  struct Entry {
+    Key key = Key();
+    double fitness = 0.0;
+    std::uint64_t last_used = 0;
+    std::size_t pending = kNotPending;
+    bool exact = false;
+    bool valid = false;
+  };
+
+  static constexpr const std::size_t NumSets(const std::size_t capacity) {
+    return capacity == 0
+               ? 0
+               : std::bit_ceil((capacity + kNumWays - 1) / kNumWays);
+  }
+
+  const Key MakeKey(const Chromosome<T, N>& chromosome) const {
+    auto key = Key();
+    for (std::size_t i = 0; i < N; ++i) {
+      auto value = chromosome[i].value();
+      if constexpr (std::is_floating_point<T>::value) {
+        if (quantum_ > 0.0) {
+          key[i] = static_cast<std::uint64_t>(std::llround(value / quantum_));
+        } else {
+          // Adding zero folds -0.0 into 0.0.
+          key[i] = std::bit_cast<std::uint64_t>(
+              static_cast<double>(value) + 0.0);
+        }
+      } else {
+        key[i] = static_cast<std::uint64_t>(value);
+      }
+    }
+
+    return key;
+  }
+
+  static constexpr const std::uint64_t Hash(const Key& key) {
+    std::uint64_t hash = 0;
+    for (auto value : key) {
+      // splitmix64 finalizer
+      hash += value + 0x9e3779b97f4a7c15;
+      hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9;
+      hash = (hash ^ (hash >> 27)) * 0x94d049bb133111eb;
+      hash ^= hash >> 31;
+    }
+
+    return hash;
+  }
+
+  Entry* Set(const Key& key) {
+    return &entries_[(Hash(key) & (num_sets_ - 1)) * kNumWays];
+  }
+
+  Entry* FindEntry(const Key& key) {
+    auto* set = Set(key);
+    for (std::size_t way = 0; way < kNumWays; ++way) {
+      if (set[way].valid && set[way].key == key) {
+        return &set[way];
+      }
+    }
+
+    return nullptr;
+  }
+
+  Entry& InsertEntry(const Key& key) {
+    auto* set = Set(key);
+    auto* victim = &set[0];
+    for (std::size_t way = 0; way < kNumWays; ++way) {
+      if (!set[way].valid) {
+        victim = &set[way];
+        break;
+      } else if (set[way].last_used < victim->last_used) {
+        victim = &set[way];
+      }
+    }
+
+    if (victim->valid) {
+      ++evictions_;
+    }
+
+    *victim = Entry();
+    victim->key = key;
+    victim->last_used = ++clock_;
+    victim->valid = true;
+
+    return *victim;
+  }
+
+  double quantum_;
+  std::size_t num_sets_;
+  std::vector<Entry> entries_;
+  std::uint64_t clock_;
+  std::size_t hits_;
+  std::size_t misses_;
+  std::size_t evictions_;
+};
+
+}  // namespace ga
+
+#endif  // GA_FITNESS_CACHE_H_
@@ -2,7 +2,6 @@
 #define GA_GENE_H_
 
 #include <iostream>
-#include <optional>
 #include <random>
 #include <type_traits>
 
@@ -32,58 +31,51 @@ class Gene {
 
     constexpr ~Bounds() = default;
 
+    constexpr Bounds& operator=(const Bounds& bounds) = default;
+
     T lower;
     T upper;
   };
 
-  constexpr Gene(const T& value = T()) : value_(value), bounds_(std::nullopt) {}
-
-  constexpr Gene(const T& lower_bound, const T& upper_bound)
-      : bounds_(Bounds(lower_bound, upper_bound)) {}
-
-  constexpr Gene(const Bounds& bounds) : bounds_(bounds) {}
-
-  constexpr Gene(const T& value, const T& lower_bound, const T& upper_bound)
-      : value_(value), bounds_(Bounds(lower_bound, upper_bound)) {}
-
-  constexpr Gene(const T& value, const Bounds& bounds)
-      : value_(value), bounds_(bounds) {}
+  // Bounds are shared by every chromosome of a population, so genes only
+  // hold their value and receive the bounds from the caller.
+  constexpr Gene(const T& value = T()) : value_(value) {}
 
-  constexpr Gene(const Gene& gene)
-      : value_(gene.value_), bounds_(gene.bounds_) {}
+  constexpr Gene(const Gene& gene) : value_(gene.value_) {}
 
   constexpr ~Gene() = default;
 
+  constexpr Gene& operator=(const Gene& gene) = default;
+
   constexpr const T& value() const { return value_; }
   constexpr T& value() { return value_; }
 
-  constexpr const std::optional<Bounds>& bounds() const { return bounds_; }
-  constexpr std::optional<Bounds>& bounds() { return bounds_; }
-
   constexpr void reset() { value_ = T(); }
 
-  void randomize() {
-    static auto mt = std::mt19937_64(std::random_device{}());
-    auto dis = bounds_.has_value()
-                   ? uniform_distribution(bounds_->lower, bounds_->upper)
-                   : uniform_distribution();
-    value_ = dis(mt);
+  // Draws the value from `generator`, such as a RandomStream. Genes hold no
+  // generator of their own, so any thread may randomize its genes.
+  template <typename Generator>
+  void randomize(Generator& generator) {
+    value_ = uniform_distribution()(generator);
+  }
+
+  template <typename Generator>
+  void randomize(const Bounds& bounds, Generator& generator) {
+    value_ = uniform_distribution(bounds.lower, bounds.upper)(generator);
   }
 
-  void validate() {
-    if (bounds_.has_value()) {
-      if (value_ < bounds_->lower) {
-        value_ = bounds_->lower;
-      } else if (value_ > bounds_->upper) {
-        value_ = bounds_->upper;
-      }
+  constexpr void validate(const Bounds& bounds) {
+    if (value_ < bounds.lower) {
+      value_ = bounds.lower;
+    } else if (value_ > bounds.upper) {
+      value_ = bounds.upper;
     }
   }
 
   friend std::ostream& operator<<<>(std::ostream& os, const Gene& gene);
 
+ private:
   T value_;
-  std::optional<Bounds> bounds_;
 };
 
 template <typename T>
@@ -0,0 +1,214 @@
+#ifndef GA_ISLAND_MODEL_H_
+#define GA_ISLAND_MODEL_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ga/migration_queue.h"
+#include "ga/random.h"
+#include "ga/termination.h"
+
+namespace ga {
+
+// `file_name` with "_<index>" inserted before its extension: the name of the
+// file island `index` writes in place of `file_name`.
+inline const std::string IslandFileName(std::string file_name,
+                                        const std::size_t index) {
+  auto extension = file_name.find_last_of('.');
+  if (extension == std::string::npos ||
+      extension < file_name.find_last_of('/') + 1) {
+    extension = file_name.size();
+  }
+
+  file_name.insert(extension, std::to_string(index));
+  return file_name.insert(extension, 1, '_');
+}
+
+// Runs several independent populations of the procedure P on their own
+// threads. Every `migration_interval` generations each island sends copies of
+// its best chromosomes to the next island in a ring, where they replace the
+// worst chromosomes if they are fitter. Each island runs with a seed derived
+// from the seed of the island arguments. P must derive from Procedure and be
+// constructible from its Args and constraints.
+template <typename P>
+class IslandModel {
+ public:
+  using chromosome_type = typename P::chromosome_type;
+  using bounds_type = typename P::bounds_type;
+
+  static constexpr const std::size_t kQueueCapacity = 64;
+
+  struct Args {
+    static constexpr const std::size_t kDefaultNumIslands = 4;
+    static constexpr const std::size_t kDefaultMigrationInterval = 10;
+    static constexpr const std::size_t kDefaultNumMigrants = 2;
+
+    constexpr Args(
+        const std::size_t num_islands = kDefaultNumIslands,
+        const std::size_t migration_interval = kDefaultMigrationInterval,
+        const std::size_t num_migrants = kDefaultNumMigrants)
+        : num_islands(num_islands),
+          migration_interval(migration_interval),
+          num_migrants(num_migrants) {}
+
+    constexpr Args(const Args& args)
+        : num_islands(args.num_islands),
+          migration_interval(args.migration_interval),
+          num_migrants(args.num_migrants) {}
+
+    constexpr ~Args() = default;
+
+    friend std::ostream& operator<<(std::ostream& os, const Args& args) {
+      os << "Islands:\t" << args.num_islands << std::endl;
+      os << "Migr. interval:\t" << args.migration_interval << std::endl;
+      os << "Migrants:\t" << args.num_migrants;
+
+      return os;
+    }
+
+    std::size_t num_islands;
+    std::size_t migration_interval;
+    std::size_t num_migrants;
+  };
+
+  IslandModel(const Args& args, const typename P::Args& island_args,
+              const std::vector<bounds_type>& constraints)
+      : args_(args),
+        island_args_(island_args),
+        constraints_(constraints),
+        log_file_name_("fitnesses.csv") {}
+
+  ~IslandModel() = default;
+
+  constexpr const Args& args() const { return args_; }
+
+  // Island i logs to this name with "_i" inserted before the extension. An
+  // empty name disables the logs.
+  const std::string& log_file_name() const { return log_file_name_; }
+  std::string& log_file_name() { return log_file_name_; }
+
+  // The rules that stop every island.
+  constexpr const TerminationRules& termination_rules() const {
+    return termination_rules_;
+  }
+  constexpr TerminationRules& termination_rules() {
+    return termination_rules_;
+  }
+
+  // The best chromosome of every island after Start.
+  constexpr const std::vector<chromosome_type>& solutions() const {
+    return solutions_;
+  }
+
+  // Runs every island to completion and returns the global best.
+  const chromosome_type Start() {
+    auto num_islands = std::max(std::size_t(1), args_.num_islands);
+
+    queues_.clear();
+    islands_.clear();
+    for (std::size_t i = 0; i < num_islands; ++i) {
+      queues_.push_back(std::make_unique<Queue>());
+    }
+    for (std::size_t i = 0; i < num_islands; ++i) {
+      islands_.push_back(std::make_unique<Island>(*this, i));
+    }
+
+    solutions_ = std::vector<chromosome_type>(num_islands);
+    {
+      auto threads = std::vector<std::jthread>();
+      threads.reserve(num_islands);
+      for (std::size_t i = 0; i < num_islands; ++i) {
+        threads.emplace_back(
+            [this, i]() { solutions_[i] = islands_[i]->Start(); });
+      }
+    }
+
+    return *std::min_element(solutions_.begin(), solutions_.end(),
+                             [](const chromosome_type& c1,
+                                const chromosome_type& c2) {
+                               return c1.fitness() < c2.fitness();
+                             });
+  }
+
+ private:
+  using Queue = MigrationQueue<chromosome_type, kQueueCapacity>;
+
+  class Island : public P {
+   public:
+    Island(IslandModel& model, const std::size_t index)
+        : P(model.island_args_, model.constraints_),
+          model_(model),
+          index_(index) {
+      this->args().seed = DeriveSeed(model.island_args_.seed, index);
+      this->termination_rules() = model.termination_rules_;
+
+      if (!model.log_file_name_.empty()) {
+        this->log_file_name() = IslandFileName(model.log_file_name_, index);
+      } else {
+        this->log_file_name().clear();
+      }
+    }
+
+    virtual ~Island() = default;
+
+   protected:
+    void OnGeneration(const std::size_t num_generations,
+                      std::vector<chromosome_type>& generation) override {
+      P::OnGeneration(num_generations, generation);
+
+      auto compare = [](const chromosome_type& c1, const chromosome_type& c2) {
+        return c1.fitness() < c2.fitness();
+      };
+
+      // Immigrants replace the worst chromosome when they are fitter.
+      auto& inbox = *model_.queues_[index_];
+      auto migrant = chromosome_type();
+      while (inbox.TryPop(migrant)) {
+        auto worst =
+            std::max_element(generation.begin(), generation.end(), compare);
+        if (worst != generation.end() && migrant.fitness() < worst->fitness()) {
+          *worst = migrant;
+        }
+      }
+
+      auto& args = model_.args_;
+      if (model_.islands_.size() < 2 || args.migration_interval == 0 ||
+          num_generations % args.migration_interval != 0) {
+        return;
+      }
+
+      auto num_migrants = std::min(args.num_migrants, generation.size());
+      std::partial_sort(generation.begin(), generation.begin() + num_migrants,
+                        generation.end(), compare);
+
+      auto& outbox = *model_.queues_[(index_ + 1) % model_.queues_.size()];
+      for (std::size_t i = 0; i < num_migrants; ++i) {
+        outbox.TryPush(generation[i]);
+      }
+    }
+
+   private:
+    IslandModel& model_;
+    std::size_t index_;
+  };
+
+  Args args_;
+  typename P::Args island_args_;
+  std::vector<bounds_type> constraints_;
+  std::string log_file_name_;
+  TerminationRules termination_rules_;
+
+  // queues_[i] holds the migrants bound for island i.
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::unique_ptr<Island>> islands_;
+  std::vector<chromosome_type> solutions_;
+};
+
+}  // namespace ga
+
+#endif  // GA_ISLAND_MODEL_H_
@@ -0,0 +1,169 @@
+#ifndef GA_LOG_SINK_H_
+#define GA_LOG_SINK_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ga {
+
+// The best fitness after a generation.
+struct LogRecord {
+  constexpr LogRecord(const std::uint64_t generation = 0,
+                      const double fitness = 0.0)
+      : generation(generation), fitness(fitness) {}
+
+  constexpr ~LogRecord() = default;
+
+  std::uint64_t generation;
+  double fitness;
+};
+
+static_assert(sizeof(LogRecord) == 16, "LogRecord must be packed");
+
+// Receives the run log of a Procedure. Write is called from the thread
+// running Start and should not block on I/O; Flush is called once Start is
+// done.
+class LogSink {
+ public:
+  virtual ~LogSink() = default;
+
+  virtual void Write(const LogRecord& record) = 0;
+  virtual void Flush() {}
+};
+
+enum class LogFormat {
+  // A "generation,fitness" header followed by one line per record.
+  kCsv,
+  // The bytes "GALG", a uint32 version and then the records as packed pairs
+  // of a uint64 generation and a double fitness, all in host byte order.
+  kBinary,
+};
+
+// Writes the run log to a file on a background thread. Write only appends to
+// an in-memory buffer; the writer takes whole batches of records at a time,
+// or whatever has been buffered once kFlushInterval passes, and flushes the
+// file after every write, so that a running log can be followed.
+class AsyncFileLogSink : public LogSink {
+ public:
+  static constexpr const std::size_t kBatchSize = 256;
+  static constexpr const std::chrono::milliseconds kFlushInterval =
+      std::chrono::milliseconds(200);
+  static constexpr const std::uint32_t kBinaryVersion = 1;
+
+  AsyncFileLogSink(const std::string& file_name,
+                   const LogFormat format = LogFormat::kCsv)
+      : file_(file_name.c_str(), format == LogFormat::kBinary
+                                     ? std::fstream::out | std::fstream::binary
+                                     : std::fstream::out),
+        format_(format),
+        flush_requested_(false),
+        num_flushes_(0) {
+    if (format_ == LogFormat::kBinary) {
+      file_.write("GALG", 4);
+      file_.write(reinterpret_cast<const char*>(&kBinaryVersion),
+                  sizeof(kBinaryVersion));
+    } else {
+      file_ << "generation,fitness\n";
+    }
+    file_.flush();
+
+    records_.reserve(kBatchSize);
+    writer_ = std::jthread([this](std::stop_token stop) { Run(stop); });
+  }
+
+  // Writes whatever is still buffered.
+  virtual ~AsyncFileLogSink() = default;
+
+  void Write(const LogRecord& record) override {
+    auto lock = std::lock_guard(mutex_);
+    records_.push_back(record);
+    if (records_.size() >= kBatchSize) {
+      pending_.notify_one();
+    }
+  }
+
+  // Blocks until every record written so far has reached the file.
+  void Flush() override {
+    auto lock = std::unique_lock(mutex_);
+    auto num_flushes = num_flushes_ + 1;
+    flush_requested_ = true;
+    pending_.notify_one();
+    flushed_.wait(lock, [this, num_flushes]() {
+      return num_flushes_ >= num_flushes;
+    });
+  }
+
+ private:
+  void Run(std::stop_token stop) {
+    auto batch = std::vector<LogRecord>();
+    batch.reserve(kBatchSize);
+
+    auto lock = std::unique_lock(mutex_);
+    while (true) {
+      pending_.wait_for(lock, stop, kFlushInterval, [this]() {
+        return records_.size() >= kBatchSize || flush_requested_;
+      });
+
+      auto stopping = stop.stop_requested();
+      auto flush = flush_requested_;
+      flush_requested_ = false;
+      batch.swap(records_);
+      lock.unlock();
+
+      if (!batch.empty()) {
+        WriteBatch(batch);
+        batch.clear();
+        file_.flush();
+      } else if (flush || stopping) {
+        file_.flush();
+      }
+
+      lock.lock();
+      if (flush) {
+        ++num_flushes_;
+        flushed_.notify_all();
+      }
+
+      if (stopping && records_.empty()) {
+        return;
+      }
+    }
+  }
+
+  void WriteBatch(const std::vector<LogRecord>& batch) {
+    if (format_ == LogFormat::kBinary) {
+      file_.write(reinterpret_cast<const char*>(batch.data()),
+                  batch.size() * sizeof(LogRecord));
+      return;
+    }
+
+    for (const auto& record : batch) {
+      file_ << record.generation << "," << record.fitness << "\n";
+    }
+  }
+
+  std::ofstream file_;
+  LogFormat format_;
+
+  std::mutex mutex_;
+  std::condition_variable_any pending_;
+  std::condition_variable_any flushed_;
+  std::vector<LogRecord> records_;
+  bool flush_requested_;
+  std::size_t num_flushes_;
+
+  // Declared last so that it is joined before the members it uses go away.
+  std::jthread writer_;
+};
+
+}  // namespace ga
+
+#endif  // GA_LOG_SINK_H_
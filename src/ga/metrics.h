@@ -0,0 +1,102 @@
+#ifndef GA_METRICS_H_
+#define GA_METRICS_H_
+
+#include <chrono>
+#include <cstddef>
+
+namespace ga {
+
+// What happened during one generation of a Procedure. Generation zero is the
+// evaluation of the initial random population.
+struct GenerationMetrics {
+  constexpr const double evaluations_per_second() const {
+    return evaluation_seconds > 0.0 ? num_evaluations / evaluation_seconds
+                                    : 0.0;
+  }
+
+  std::size_t generation = 0;
+
+  // Wall time of the whole generation and of each of its phases, in seconds.
+  // Selection includes ranking the previous generation and keeping its
+  // survivors.
+  double seconds = 0.0;
+  double evaluation_seconds = 0.0;
+  double selection_seconds = 0.0;
+  double crossover_seconds = 0.0;
+  double mutation_seconds = 0.0;
+
+  // Chromosomes that were actually simulated at full fidelity, those that
+  // were only screened, the samples all of them took and how many
+  // simulations were cut short by bounded evaluation. Chromosomes whose
+  // fitness the surrogate predicted were not simulated at all.
+  std::size_t num_evaluations = 0;
+  std::size_t num_screened = 0;
+  std::size_t num_predicted = 0;
+  std::size_t num_steps = 0;
+  std::size_t num_aborted = 0;
+
+  std::size_t cache_hits = 0;
+  std::size_t cache_misses = 0;
+
+  // Mean standard deviation of each gene across the population, relative to
+  // the width of its bounds when the gene is constrained.
+  double diversity = 0.0;
+
+  double best_fitness = 0.0;
+  double mean_fitness = 0.0;
+  double worst_fitness = 0.0;
+};
+
+// Receives the metrics of every generation from the thread running
+// Procedure::Start.
+class MetricsObserver {
+ public:
+  virtual ~MetricsObserver() = default;
+
+  virtual void OnMetrics(const GenerationMetrics& metrics) = 0;
+};
+
+// Splits wall time into consecutive phases. A disabled timer never reads the
+// clock.
+class PhaseTimer {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit PhaseTimer(const bool enabled)
+      : enabled_(enabled),
+        start_(enabled ? Clock::now() : Clock::time_point()),
+        lap_(start_) {}
+
+  ~PhaseTimer() = default;
+
+  constexpr const bool enabled() const { return enabled_; }
+
+  // Adds the time since the previous lap to `seconds`.
+  void Lap(double& seconds) {
+    if (!enabled_) {
+      return;
+    }
+
+    auto now = Clock::now();
+    seconds += std::chrono::duration<double>(now - lap_).count();
+    lap_ = now;
+  }
+
+  // The time since construction, in seconds.
+  const double Elapsed() const {
+    if (!enabled_) {
+      return 0.0;
+    }
+
+    return std::chrono::duration<double>(Clock::now() - start_).count();
+  }
+
+ private:
+  bool enabled_;
+  Clock::time_point start_;
+  Clock::time_point lap_;
+};
+
+}  // namespace ga
+
+#endif  // GA_METRICS_H_
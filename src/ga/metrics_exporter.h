@@ -0,0 +1,179 @@
+#ifndef GA_METRICS_EXPORTER_H_
+#define GA_METRICS_EXPORTER_H_
+
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <ostream>
+#include <string>
+
+#include "ga/metrics.h"
+
+namespace ga {
+
+// Appends every generation's metrics to a file as one JSON object per line.
+class JsonLinesExporter : public MetricsObserver {
+ public:
+  explicit JsonLinesExporter(const std::string& file_name)
+      : file_(file_name.c_str(), std::fstream::out) {
+    file_.precision(std::numeric_limits<double>::max_digits10);
+  }
+
+  virtual ~JsonLinesExporter() = default;
+
+  void OnMetrics(const GenerationMetrics& metrics) override {
+    file_ << "{\"generation\":" << metrics.generation
+          << ",\"seconds\":" << metrics.seconds
+          << ",\"evaluation_seconds\":" << metrics.evaluation_seconds
+          << ",\"selection_seconds\":" << metrics.selection_seconds
+          << ",\"crossover_seconds\":" << metrics.crossover_seconds
+          << ",\"mutation_seconds\":" << metrics.mutation_seconds
+          << ",\"evaluations\":" << metrics.num_evaluations
+          << ",\"evaluations_per_second\":" << metrics.evaluations_per_second()
+          << ",\"screened\":" << metrics.num_screened
+          << ",\"predicted\":" << metrics.num_predicted
+          << ",\"steps\":" << metrics.num_steps
+          << ",\"aborted\":" << metrics.num_aborted
+          << ",\"cache_hits\":" << metrics.cache_hits
+          << ",\"cache_misses\":" << metrics.cache_misses
+          << ",\"diversity\":" << metrics.diversity
+          << ",\"best_fitness\":" << metrics.best_fitness
+          << ",\"mean_fitness\":" << metrics.mean_fitness
+          << ",\"worst_fitness\":" << metrics.worst_fitness << "}\n";
+    file_.flush();
+  }
+
+ private:
+  std::ofstream file_;
+};
+
+// Keeps a Prometheus text exposition file up to date, for example for the
+// node exporter's textfile collector. Counters accumulate over the whole run;
+// gauges describe the latest generation. The file is replaced atomically
+// every `interval` generations.
+class PrometheusExporter : public MetricsObserver {
+ public:
+  PrometheusExporter(const std::string& file_name,
+                     const std::string& prefix = "ga",
+                     const std::size_t interval = 1)
+      : file_name_(file_name),
+        prefix_(prefix),
+        interval_(interval == 0 ? 1 : interval) {}
+
+  virtual ~PrometheusExporter() = default;
+
+  void OnMetrics(const GenerationMetrics& metrics) override {
+    totals_.generation = metrics.generation;
+    totals_.seconds += metrics.seconds;
+    totals_.evaluation_seconds += metrics.evaluation_seconds;
+    totals_.selection_seconds += metrics.selection_seconds;
+    totals_.crossover_seconds += metrics.crossover_seconds;
+    totals_.mutation_seconds += metrics.mutation_seconds;
+    totals_.num_evaluations += metrics.num_evaluations;
+    totals_.num_screened += metrics.num_screened;
+    totals_.num_predicted += metrics.num_predicted;
+    totals_.num_steps += metrics.num_steps;
+    totals_.num_aborted += metrics.num_aborted;
+    totals_.cache_hits += metrics.cache_hits;
+    totals_.cache_misses += metrics.cache_misses;
+
+    if (metrics.generation % interval_ == 0) {
+      Write(metrics);
+    }
+  }
+
+ private:
+  void Write(const GenerationMetrics& latest) const {
+    auto temp_file_name = file_name_ + ".tmp";
+    {
+      auto file = std::ofstream(temp_file_name.c_str(), std::fstream::out);
+      file.precision(std::numeric_limits<double>::max_digits10);
+
+      Metric(file, "generation", "gauge", "Latest completed generation.");
+      Sample(file, "generation", "", latest.generation);
+
+      Metric(file, "phase_seconds_total", "counter",
+             "Wall time spent in each phase of a generation.");
+      Sample(file, "phase_seconds_total", "phase=\"evaluation\"",
+             totals_.evaluation_seconds);
+      Sample(file, "phase_seconds_total", "phase=\"selection\"",
+             totals_.selection_seconds);
+      Sample(file, "phase_seconds_total", "phase=\"crossover\"",
+             totals_.crossover_seconds);
+      Sample(file, "phase_seconds_total", "phase=\"mutation\"",
+             totals_.mutation_seconds);
+
+      Metric(file, "generation_seconds", "gauge",
+             "Wall time of the latest generation.");
+      Sample(file, "generation_seconds", "", latest.seconds);
+
+      Metric(file, "evaluations_total", "counter", "Simulated chromosomes.");
+      Sample(file, "evaluations_total", "", totals_.num_evaluations);
+
+      Metric(file, "evaluations_per_second", "gauge",
+             "Evaluation throughput of the latest generation.");
+      Sample(file, "evaluations_per_second", "",
+             latest.evaluations_per_second());
+
+      Metric(file, "screened_evaluations_total", "counter",
+             "Chromosomes only simulated at low fidelity.");
+      Sample(file, "screened_evaluations_total", "", totals_.num_screened);
+
+      Metric(file, "predicted_evaluations_total", "counter",
+             "Chromosomes whose fitness the surrogate predicted.");
+      Sample(file, "predicted_evaluations_total", "", totals_.num_predicted);
+
+      Metric(file, "simulated_steps_total", "counter", "Simulated samples.");
+      Sample(file, "simulated_steps_total", "", totals_.num_steps);
+
+      Metric(file, "aborted_evaluations_total", "counter",
+             "Evaluations cut short by bounded evaluation.");
+      Sample(file, "aborted_evaluations_total", "", totals_.num_aborted);
+
+      Metric(file, "cache_hits_total", "counter", "Fitness cache hits.");
+      Sample(file, "cache_hits_total", "", totals_.cache_hits);
+
+      Metric(file, "cache_misses_total", "counter", "Fitness cache misses.");
+      Sample(file, "cache_misses_total", "", totals_.cache_misses);
+
+      Metric(file, "diversity", "gauge",
+             "Mean relative standard deviation of the genes.");
+      Sample(file, "diversity", "", latest.diversity);
+
+      Metric(file, "fitness", "gauge",
+             "Fitness statistics of the latest generation.");
+      Sample(file, "fitness", "stat=\"best\"", latest.best_fitness);
+      Sample(file, "fitness", "stat=\"mean\"", latest.mean_fitness);
+      Sample(file, "fitness", "stat=\"worst\"", latest.worst_fitness);
+    }
+
+    std::rename(temp_file_name.c_str(), file_name_.c_str());
+  }
+
+  void Metric(std::ostream& os, const std::string& name,
+              const std::string& type, const std::string& help) const {
+    os << "# HELP " << prefix_ << "_" << name << " " << help << "\n";
+    os << "# TYPE " << prefix_ << "_" << name << " " << type << "\n";
+  }
+
+  template <typename V>
+  void Sample(std::ostream& os, const std::string& name,
+              const std::string& labels, const V value) const {
+    os << prefix_ << "_" << name;
+    if (!labels.empty()) {
+      os << "{" << labels << "}";
+    }
+    os << " " << value << "\n";
+  }
+
+  std::string file_name_;
+  std::string prefix_;
+  std::size_t interval_;
+
+  GenerationMetrics totals_;
+};
+
+}  // namespace ga
+
+#endif  // GA_METRICS_EXPORTER_H_
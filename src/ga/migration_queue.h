@@ -0,0 +1,61 @@
+#ifndef GA_MIGRATION_QUEUE_H_
+#define GA_MIGRATION_QUEUE_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace ga {
+
+// Bounded lock-free single-producer single-consumer ring buffer used to pass
+// migrants from one island to the next. Pushing to a full queue fails instead
+// of blocking, so a slow island never stalls its neighbour.
+template <typename T, std::size_t Capacity>
+class MigrationQueue {
+ public:
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                "Capacity must be a power of two");
+
+  MigrationQueue() : head_(0), tail_(0) {}
+  ~MigrationQueue() = default;
+
+  MigrationQueue(const MigrationQueue&) = delete;
+  MigrationQueue& operator=(const MigrationQueue&) = delete;
+
+  // Producer side.
+  bool TryPush(const T& value) {
+    auto tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == Capacity) {
+      return false;
+    }
+
+    slots_[tail & (Capacity - 1)] = value;
+    tail_.store(tail + 1, std::memory_order_release);
+
+    return true;
+  }
+
+  // Consumer side.
+  bool TryPop(T& value) {
+    auto head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+
+    value = slots_[head & (Capacity - 1)];
+    head_.store(head + 1, std::memory_order_release);
+
+    return true;
+  }
+
+ private:
+  std::array<T, Capacity> slots_;
+
+  // Kept on separate cache lines so producer and consumer do not contend.
+  alignas(64) std::atomic<std::size_t> head_;
+  alignas(64) std::atomic<std::size_t> tail_;
+};
+
+}  // namespace ga
+
+#endif  // GA_MIGRATION_QUEUE_H_
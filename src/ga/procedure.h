@@ -2,23 +2,64 @@
 #define GA_PROCEDURE_H_
 
 #include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <cstddef>
-#include <fstream>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
-#include <iterator>
+#include <limits>
+#include <memory>
 #include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
+#include "ga/alias_table.h"
+#include "ga/checkpoint.h"
 #include "ga/chromosome.h"
+#include "ga/fitness_cache.h"
+#include "ga/log_sink.h"
+#include "ga/metrics.h"
+#include "ga/random.h"
+#include "ga/surrogate.h"
+#include "ga/termination.h"
+#include "ga/work_pool.h"
 
 namespace ga {
 
 template <typename T, std::size_t N>
 class Procedure {
  public:
+  using chromosome_type = Chromosome<T, N>;
+  using bounds_type = typename Gene<T>::Bounds;
+
   static constexpr const double kAlpha = 0.5;
   static constexpr const std::size_t kNumSurvivors = 2;
 
+  static constexpr const std::size_t kDefaultCheckpointInterval = 10;
+  static constexpr const std::uint32_t kCheckpointVersion = 7;
+
+  // How often a parent is redrawn when it is the same chromosome as the other
+  // parent of a pair.
+  static constexpr const std::size_t kMaxParentRedraws = 8;
+
+  // The share of the chromosomes the surrogate lets through that are picked
+  // for lying furthest from every archived chromosome rather than for their
+  // predicted fitness.
+  static constexpr const double kSurrogateExploration = 0.25;
+
+  enum class Selection : std::uint8_t {
+    // Roulette wheel over the fitnesses.
+    kFitnessProportionate,
+    // The fittest of `tournament_size` uniformly drawn chromosomes.
+    kTournament,
+    // Roulette wheel over linear ranks, the fittest weighing the most.
+    kRank,
+  };
+
   struct Args {
     static constexpr const std::size_t kDefaultPopulationSize = 50;
     static constexpr const std::size_t kDefaultNumGenerations = 150;
@@ -26,92 +67,486 @@ class Procedure {
     static constexpr const double kDefaultCrossoverPr = 0.6;
     static constexpr const double kDefaultMutationPr = 0.25;
 
+    // A worker count of zero uses every hardware thread.
+    static constexpr const std::size_t kDefaultNumWorkers = 1;
+
+    // Bounded evaluation lets Fitness give up on chromosomes that cannot beat
+    // the worst survivor of the previous generation. Such offspring all rank
+    // equal just behind it whether they were simulated in full or not, see
+    // Procedure::Censor, so the flag only changes the cost of a run, never
+    // its result.
+    static constexpr const bool kDefaultBoundedEvaluation = true;
+
+    // Fitnesses of up to this many distinct chromosomes are remembered so
+    // that survivors and unchanged parents are not simulated again. Genes are
+    // compared after rounding to multiples of the quantum, if it is non-zero.
+    static constexpr const std::size_t kDefaultCacheCapacity = 4096;
+    static constexpr const double kDefaultCacheQuantum = 0.0;
+
+    static constexpr const Selection kDefaultSelection =
+        Selection::kFitnessProportionate;
+    static constexpr const std::size_t kDefaultTournamentSize = 2;
+
+    // Multi-fidelity evaluation first screens every chromosome that needs
+    // simulating with a cheap estimate and only evaluates this fraction of
+    // them, the most promising, at full fidelity. The others keep their
+    // estimate, raised so that it never beats a fully evaluated chromosome.
+    // Zero, or a Procedure that cannot screen, evaluates everything at full
+    // fidelity.
+    static constexpr const double kDefaultScreeningFraction = 0.0;
+
+    // The surrogate predicts the fitness of every chromosome that needs
+    // simulating from an archive of earlier simulations, and only this
+    // fraction of them is simulated; the others keep their prediction, raised
+    // like a screening estimate. It is used once the archive holds a
+    // population's worth of chromosomes. Zero disables it.
+    static constexpr const double kDefaultSurrogateFraction = 0.0;
+
+    // Every random draw of a run derives from its seed, see RandomStream, so
+    // a seed reproduces a run exactly, whatever the number of workers. Zero
+    // draws a seed from std::random_device when the run starts.
+    static constexpr const std::uint64_t kDefaultSeed = 0;
+
     constexpr Args(const std::size_t population_size = kDefaultPopulationSize,
                    const std::size_t num_generations = kDefaultNumGenerations,
                    const double crossover_pr = kDefaultCrossoverPr,
-                   const double mutation_pr = kDefaultMutationPr)
+                   const double mutation_pr = kDefaultMutationPr,
+                   const std::size_t num_workers = kDefaultNumWorkers,
+                   const bool bounded_evaluation = kDefaultBoundedEvaluation,
+                   const std::size_t cache_capacity = kDefaultCacheCapacity,
+                   const double cache_quantum = kDefaultCacheQuantum,
+                   const Selection selection = kDefaultSelection,
+                   const std::size_t tournament_size = kDefaultTournamentSize,
+                   const double screening_fraction = kDefaultScreeningFraction,
+                   const double surrogate_fraction = kDefaultSurrogateFraction,
+                   const std::uint64_t seed = kDefaultSeed)
         : population_size(population_size),
           num_generations(num_generations),
           crossover_pr(crossover_pr),
-          mutation_pr(mutation_pr) {}
+          mutation_pr(mutation_pr),
+          num_workers(num_workers),
+          bounded_evaluation(bounded_evaluation),
+          cache_capacity(cache_capacity),
+          cache_quantum(cache_quantum),
+          selection(selection),
+          tournament_size(tournament_size),
+          screening_fraction(screening_fraction),
+          surrogate_fraction(surrogate_fraction),
+          seed(seed) {}
 
     constexpr Args(const Args& args)
         : population_size(args.population_size),
           num_generations(args.num_generations),
           crossover_pr(args.crossover_pr),
-          mutation_pr(args.mutation_pr) {}
+          mutation_pr(args.mutation_pr),
+          num_workers(args.num_workers),
+          bounded_evaluation(args.bounded_evaluation),
+          cache_capacity(args.cache_capacity),
+          cache_quantum(args.cache_quantum),
+          selection(args.selection),
+          tournament_size(args.tournament_size),
+          screening_fraction(args.screening_fraction),
+          surrogate_fraction(args.surrogate_fraction),
+          seed(args.seed) {}
 
     constexpr ~Args() = default;
 
+    constexpr Args& operator=(const Args& args) = default;
+
     friend std::ostream& operator<<(std::ostream& os, const Args& args) {
       os << "Population:\t" << args.population_size << std::endl;
       os << "Generations:\t" << args.num_generations << std::endl;
       os << "Crossover pr.:\t" << args.crossover_pr << std::endl;
-      os << "Mutation pr.:\t" << args.mutation_pr;
+      os << "Mutation pr.:\t" << args.mutation_pr << std::endl;
+      os << "Workers:\t" << args.num_workers << std::endl;
+      os << "Bounded eval.:\t" << std::boolalpha << args.bounded_evaluation
+         << std::noboolalpha << std::endl;
+      os << "Cache capacity:\t" << args.cache_capacity << std::endl;
+      os << "Cache quantum:\t" << args.cache_quantum << std::endl;
+      os << "Selection:\t";
+      switch (args.selection) {
+        case Selection::kFitnessProportionate:
+          os << "fitness proportionate";
+          break;
+        case Selection::kTournament:
+          os << "tournament of " << args.tournament_size;
+          break;
+        case Selection::kRank:
+          os << "rank";
+          break;
+      }
+
+      if (args.screening_fraction > 0.0) {
+        os << std::endl
+           << "Screening:\t" << args.screening_fraction
+           << " at full fidelity";
+      }
+
+      if (args.surrogate_fraction > 0.0) {
+        os << std::endl
+           << "Surrogate:\t" << args.surrogate_fraction << " simulated";
+      }
+
+      if (args.seed != 0) {
+        os << std::endl << "Seed:\t\t" << args.seed;
+      }
 
       return os;
     }
 
+    void Save(CheckpointEncoder& encoder) const {
+      encoder.Put(static_cast<std::uint64_t>(population_size));
+      encoder.Put(static_cast<std::uint64_t>(num_generations));
+      encoder.Put(crossover_pr);
+      encoder.Put(mutation_pr);
+      encoder.Put(static_cast<std::uint64_t>(num_workers));
+      encoder.Put(static_cast<std::uint8_t>(bounded_evaluation));
+      encoder.Put(static_cast<std::uint64_t>(cache_capacity));
+      encoder.Put(cache_quantum);
+      encoder.Put(selection);
+      encoder.Put(static_cast<std::uint64_t>(tournament_size));
+      encoder.Put(screening_fraction);
+      encoder.Put(surrogate_fraction);
+      encoder.Put(seed);
+    }
+
+    void Restore(CheckpointDecoder& decoder) {
+      population_size = decoder.Get<std::uint64_t>();
+      num_generations = decoder.Get<std::uint64_t>();
+      crossover_pr = decoder.Get<double>();
+      mutation_pr = decoder.Get<double>();
+      num_workers = decoder.Get<std::uint64_t>();
+      bounded_evaluation = decoder.Get<std::uint8_t>() != 0;
+      cache_capacity = decoder.Get<std::uint64_t>();
+      cache_quantum = decoder.Get<double>();
+      selection = decoder.Get<Selection>();
+      tournament_size = decoder.Get<std::uint64_t>();
+      screening_fraction = decoder.Get<double>();
+      surrogate_fraction = decoder.Get<double>();
+      seed = decoder.Get<std::uint64_t>();
+    }
+
     std::size_t population_size;
     std::size_t num_generations;
     double crossover_pr;
     double mutation_pr;
+    std::size_t num_workers;
+    bool bounded_evaluation;
+    std::size_t cache_capacity;
+    double cache_quantum;
+    Selection selection;
+    std::size_t tournament_size;
+    double screening_fraction;
+    double surrogate_fraction;
+    std::uint64_t seed;
   };
 
   constexpr Procedure(
       const Args& args = Args(),
       const std::vector<typename Gene<T>::Bounds>& constraints = {})
-      : args_(args), constraints_(constraints), mt_(std::random_device{}()) {}
+      : args_(args),
+        constraints_(constraints),
+        offspring_generation_(0),
+        cache_(args.cache_capacity, args.cache_quantum),
+        log_file_name_("fitnesses.csv"),
+        log_format_(LogFormat::kCsv),
+        log_sink_(nullptr),
+        executor_(nullptr),
+        stop_requested_(false),
+        checkpoint_interval_(kDefaultCheckpointInterval),
+        resumed_(false),
+        resumed_num_generations_(0),
+        termination_reason_(0) {}
 
   virtual constexpr ~Procedure() = default;
 
   constexpr const Args& args() const { return args_; }
   constexpr Args& args() { return args_; }
 
+  constexpr const FitnessCache<T, N>& cache() const { return cache_; }
+
+  // Stopping rules in addition to Args::num_generations.
+  constexpr const TerminationRules& termination_rules() const {
+    return termination_rules_;
+  }
+  constexpr TerminationRules& termination_rules() {
+    return termination_rules_;
+  }
+
+  // The TerminationRules::Rule bits that ended the last Start.
+  constexpr const unsigned termination_reason() const {
+    return termination_reason_;
+  }
+
+  // Asks a running Start to finish after the current generation. Safe to
+  // call from any thread.
+  void RequestStop() { stop_requested_.store(true, std::memory_order_relaxed); }
+
+  // The per-generation best fitness log, written off the evaluation thread.
+  // An empty name disables it.
+  const std::string& log_file_name() const { return log_file_name_; }
+  std::string& log_file_name() { return log_file_name_; }
+
+  constexpr const LogFormat log_format() const { return log_format_; }
+  constexpr LogFormat& log_format() { return log_format_; }
+
+  // Sends the run log to `sink` instead of the log file. The sink must
+  // outlive Start.
+  void set_log_sink(LogSink* sink) { log_sink_ = sink; }
+
+  // Runs the evaluation workers on `executor`, such as a WorkPool shared with
+  // other runs, instead of on threads started for every generation. A worker
+  // count of zero then uses every thread of the executor. The executor must
+  // outlive Start.
+  void set_executor(Executor* executor) { executor_ = executor; }
+
+  // Every `checkpoint_interval` generations the full state of the run is
+  // saved to the checkpoint file from a background thread. A checkpoint that
+  // falls due while the previous one is still being written is taken after
+  // the next generation instead. An empty name disables checkpoints.
+  const std::string& checkpoint_file_name() const {
+    return checkpoint_file_name_;
+  }
+  std::string& checkpoint_file_name() { return checkpoint_file_name_; }
+
+  constexpr const std::size_t checkpoint_interval() const {
+    return checkpoint_interval_;
+  }
+  constexpr std::size_t& checkpoint_interval() { return checkpoint_interval_; }
+
+  // Restores the arguments, seed included, constraints, population,
+  // generation counter and fitness cache saved in a checkpoint, so that the
+  // next Start continues exactly where the checkpointed run was.
+  void Resume(const std::string& file_name) {
+    auto buffer = ReadCheckpoint(file_name);
+    auto decoder = CheckpointDecoder(buffer);
+    RestoreCheckpoint(decoder);
+  }
+
+  // Reports the metrics of every generation to `observer`, which must outlive
+  // Start. Without observers the clock is never read and no statistics are
+  // gathered.
+  void AddMetricsObserver(MetricsObserver* observer) {
+    metrics_observers_.push_back(observer);
+  }
+
+  const std::size_t num_workers() const {
+    auto num_workers = args_.num_workers;
+    if (num_workers == 0) {
+      num_workers =
+          executor_ ? executor_->size()
+                    : std::max(1U, std::thread::hardware_concurrency());
+    }
+
+    return std::max(std::size_t(1),
+                    std::min(num_workers, args_.population_size));
+  }
+
   const Chromosome<T, N> Start() {
-    auto csv_file = std::ofstream("fitnesses.csv", std::fstream::out);
-    csv_file << "generation,fitness" << std::endl;
+    auto file_log_sink = std::unique_ptr<LogSink>();
+    auto* log_sink = log_sink_;
+    if (!log_sink && !log_file_name_.empty()) {
+      file_log_sink =
+          std::make_unique<AsyncFileLogSink>(log_file_name_, log_format_);
+      log_sink = file_log_sink.get();
+    }
+
+    if (args_.seed == 0) {
+      args_.seed = RandomSeed();
+    }
+
+    ReserveWorkers(num_workers());
+    surrogate_.set_bounds(constraints_);
+    simulation_counters_ = std::vector<SimulationCounters>(num_workers());
 
     Chromosome<T, N>* solution = nullptr;
 
-    auto generation = RandomGeneration();
-    EvaluateFitness(generation);
+    auto instrumented = !metrics_observers_.empty();
+    auto metrics = GenerationMetrics();
+    auto timer = PhaseTimer(instrumented);
+
+    auto checkpoint_writer = std::unique_ptr<CheckpointWriter>();
+    if (!checkpoint_file_name_.empty() && checkpoint_interval_ > 0) {
+      checkpoint_writer =
+          std::make_unique<CheckpointWriter>(checkpoint_file_name_);
+    }
+    auto checkpoint_due = false;
+
+    termination_.Restart(resumed_);
+    termination_reason_ = 0;
 
+    auto generation = std::vector<Chromosome<T, N>>();
     std::size_t num_generations = 0;
+    if (resumed_) {
+      // The restored monitor has already seen this generation.
+      generation = std::move(resumed_generation_);
+      num_generations = resumed_num_generations_;
+      resumed_ = false;
+
+      solution = &*std::min_element(generation.begin(), generation.end(),
+                                    CompareFitness());
+    } else {
+      generation = RandomGeneration();
+      EvaluateFitness(generation);
+      timer.Lap(metrics.evaluation_seconds);
+
+      solution = &*std::min_element(generation.begin(), generation.end(),
+                                    CompareFitness());
+      termination_.Update(solution->fitness());
+
+      if (instrumented) {
+        ReportMetrics(0, generation, timer, metrics);
+      }
+    }
+
+    // The next generation is built in place in a second buffer and the two
+    // are swapped, so a generation costs no allocations once both buffers
+    // have grown to the population size.
+    auto next_generation = std::vector<Chromosome<T, N>>();
+    next_generation.reserve(generation.size());
+    auto parents = std::vector<Parent>();
+    parents.reserve(generation.size() / 2);
+
     while (!Terminate(num_generations)) {
-      std::sort(generation.begin(), generation.end(), CompareFitness());
-      auto new_generation = std::vector<Chromosome<T, N>>(
-          generation.begin(), generation.begin() + kNumSurvivors);
+      metrics = GenerationMetrics();
+      timer = PhaseTimer(instrumented);
 
-      auto offspring = WholeArithmeticCrossover(SelectParentsFPS(generation));
+      // Only the survivors need to be in order.
+      auto num_survivors = std::min(kNumSurvivors, generation.size());
+      std::partial_sort(generation.begin(),
+                        generation.begin() + num_survivors, generation.end(),
+                        CompareFitness());
 
-      UniformMutation(offspring);
+      auto cost_bound = CostBound(generation);
+      auto survivor_bound = SurvivorBound(generation);
 
-      new_generation.insert(new_generation.end(),
-                            std::make_move_iterator(offspring.begin()),
-                            std::make_move_iterator(offspring.end()));
+      offspring_generation_ = num_generations + 1;
+      SelectParents(generation, parents);
+      timer.Lap(metrics.selection_seconds);
 
-      EvaluateFitness(new_generation);
+      next_generation.resize(num_survivors + 2 * parents.size());
+      std::copy(generation.begin(), generation.begin() + num_survivors,
+                next_generation.begin());
 
-      generation = new_generation;
+      WholeArithmeticCrossover(parents, next_generation, num_survivors);
+      timer.Lap(metrics.crossover_seconds);
+
+      UniformMutation(next_generation, num_survivors);
+      timer.Lap(metrics.mutation_seconds);
+
+      EvaluateFitness(next_generation, cost_bound, survivor_bound);
+      timer.Lap(metrics.evaluation_seconds);
+
+      generation.swap(next_generation);
       ++num_generations;
 
+      OnGeneration(num_generations, generation);
+
+      if (instrumented) {
+        ReportMetrics(num_generations, generation, timer, metrics);
+      }
+
       solution = &*std::min_element(generation.begin(), generation.end(),
                                     CompareFitness());
+      termination_.Update(solution->fitness());
+
+      if (log_sink) {
+        log_sink->Write(LogRecord(num_generations, solution->fitness()));
+      }
+
+      if (checkpoint_writer) {
+        checkpoint_due = checkpoint_due ||
+                         num_generations % checkpoint_interval_ == 0;
+        if (checkpoint_due) {
+          SaveCheckpoint(generation, num_generations, checkpoint_buffer_);
+          checkpoint_due = !checkpoint_writer->TryWrite(checkpoint_buffer_);
+        }
+      }
+    }
 
-      csv_file << num_generations << "," << solution->fitness() << std::endl;
+    // Reports a checkpoint that failed to reach the disk.
+    if (checkpoint_writer) {
+      checkpoint_writer->Wait();
     }
 
-    csv_file.close();
+    if (args_.surrogate_fraction > 0.0 ||
+        (supports_screening() && args_.screening_fraction > 0.0)) {
+      VerifyBest(generation);
+    }
+
+    OnFinish(generation);
+    solution = &*std::min_element(generation.begin(), generation.end(),
+                                  CompareFitness());
+
+    if (log_sink) {
+      log_sink->Flush();
+    }
 
     return *solution;
   }
 
  protected:
-  virtual constexpr const double Fitness(
-      const Chromosome<T, N>& chromosome) = 0;
+  // Called concurrently when more than one worker is configured. Each worker
+  // passes its own index in [0, num_workers()), so implementations may keep
+  // per-worker state without locking. Implementations may stop early once the
+  // fitness is known to exceed `cost_bound` and return any value above it.
+  virtual constexpr const double Fitness(const Chromosome<T, N>& chromosome,
+                                         const std::size_t worker,
+                                         const double cost_bound) = 0;
+
+  // The largest number of chromosomes FitnessBatch prefers to evaluate at
+  // once.
+  virtual constexpr const std::size_t batch_size() const { return 1; }
+
+  // Evaluates `count` chromosomes on `worker`. Implementations that can
+  // simulate several chromosomes at once override this together with
+  // batch_size(); the same concurrency and `cost_bound` rules as Fitness
+  // apply.
+  virtual void FitnessBatch(Chromosome<T, N>* const* chromosomes,
+                            const std::size_t count, const std::size_t worker,
+                            const double cost_bound) {
+    for (std::size_t i = 0; i < count; ++i) {
+      chromosomes[i]->fitness() = Fitness(*chromosomes[i], worker, cost_bound);
+    }
+  }
+
+  // Implementations that can estimate fitness more cheaply than Fitness
+  // return true and override ScreenBatch to enable multi-fidelity evaluation,
+  // see Args::screening_fraction.
+  virtual constexpr const bool supports_screening() const { return false; }
+
+  // Sets the fitness of `count` chromosomes to a low-fidelity estimate that
+  // ranks them like Fitness would. The same concurrency and `cost_bound`
+  // rules as Fitness apply.
+  virtual void ScreenBatch(Chromosome<T, N>* const* /*chromosomes*/,
+                           const std::size_t /*count*/,
+                           const std::size_t /*worker*/,
+                           const double /*cost_bound*/) {}
+
+  // Called before the first evaluation so implementations can size their
+  // per-worker state.
+  virtual void ReserveWorkers(const std::size_t /*num_workers*/) {}
+
+  // Called after every generation has been evaluated. Implementations may
+  // replace chromosomes as long as their fitness stays valid.
+  virtual void OnGeneration(const std::size_t /*num_generations*/,
+                            std::vector<Chromosome<T, N>>& /*generation*/) {}
+
+  // Called once with the final generation when the run stops, before the
+  // solution is picked from it. Implementations may re-evaluate chromosomes,
+  // for instance more accurately than during the run.
+  virtual void OnFinish(std::vector<Chromosome<T, N>>& /*generation*/) {}
+
+  // Lets Fitness implementations report the cost of a simulation for the
+  // generation metrics. Each worker only touches its own counters.
+  void CountSimulation(const std::size_t worker, const std::size_t num_steps,
+                       const bool aborted) {
+    if (worker < simulation_counters_.size()) {
+      simulation_counters_[worker].num_steps += num_steps;
+      simulation_counters_[worker].num_aborted += aborted;
+    }
+  }
 
- private:
   struct Parent {
     constexpr Parent(const Chromosome<T, N>* first = nullptr,
                      const Chromosome<T, N>* second = nullptr)
@@ -129,96 +564,573 @@ class Procedure {
     }
   };
 
-  struct CompareSelectionPr {
-    constexpr const bool operator()(const Chromosome<T, N>& c1,
-                                    const Chromosome<T, N>& c2) const {
-      return c1.selection_pr() < c2.selection_pr();
+  // Checks the generation limit, stop requests and the termination rules,
+  // and records which of them fired.
+  const bool Terminate(const std::size_t num_generations) {
+    termination_reason_ = termination_.Check(
+        termination_rules_, num_generations > args_.num_generations,
+        stop_requested_.load(std::memory_order_relaxed));
+
+    return termination_reason_ != 0;
+  }
+
+  // The fitness of the worst survivor of a generation whose survivors are
+  // sorted to its front. Offspring that
+  // are worse than it can never displace a survivor, so their exact fitness is
+  // not needed.
+  constexpr const double CostBound(
+      const std::vector<Chromosome<T, N>>& generation) const {
+    if (!args_.bounded_evaluation || generation.size() < kNumSurvivors ||
+        kNumSurvivors == 0) {
+      return std::numeric_limits<double>::infinity();
+    }
+
+    return generation[kNumSurvivors - 1].fitness();
+  }
+
+  // The fitness of the worst survivor of a sorted generation, which every
+  // estimate of the next generation must rank behind. Infinite without
+  // survivors.
+  constexpr const double SurvivorBound(
+      const std::vector<Chromosome<T, N>>& generation) const {
+    auto num_survivors = std::min(kNumSurvivors, generation.size());
+    if (num_survivors == 0) {
+      return std::numeric_limits<double>::infinity();
     }
-  };
 
-  constexpr const bool Terminate(const std::size_t num_generations) const {
-    // Termination criteria could be:
-    // * Specified number of generations or fitness evaluations
-    // * Minimum (solution) threshold reached
-    // * No improvement in best individual for a specified number of
-    // generations
-    // * Memory/time constraints
+    return generation[num_survivors - 1].fitness();
+  }
 
-    return num_generations > args_.num_generations;
+  // Offspring that cannot beat the worst survivor all get the fitness just
+  // above `survivor_bound`, whether they were simulated in full or given up
+  // on at a lower bound, so that selection cannot tell bounded evaluation
+  // from a full one.
+  static constexpr const double Censor(const double fitness,
+                                       const double survivor_bound) {
+    return fitness > survivor_bound
+               ? std::nextafter(survivor_bound,
+                                std::numeric_limits<double>::infinity())
+               : fitness;
   }
 
   constexpr const std::vector<Chromosome<T, N>> RandomGeneration() const {
     auto generation = std::vector<Chromosome<T, N>>(args_.population_size);
-    for (auto& chromosome : generation) {
-      chromosome = Chromosome<T, N>(constraints_);
-      chromosome.randomize();
+    for (std::size_t i = 0; i < generation.size(); ++i) {
+      auto random = RandomStream(args_.seed, 0, Stream::kInitialization, i);
+      generation[i].randomize(random, constraints_);
     }
 
     return generation;
   }
 
-  constexpr void EvaluateFitness(std::vector<Chromosome<T, N>>& generation) {
-    for (auto& chromosome : generation) {
-      chromosome.fitness() = Fitness(chromosome);
+  // Completes `metrics` for a generation that has just been evaluated and
+  // hands it to every observer. Simulation and cache counters are drained so
+  // that each report only covers its own generation.
+  void ReportMetrics(const std::size_t num_generations,
+                     const std::vector<Chromosome<T, N>>& generation,
+                     const PhaseTimer& timer, GenerationMetrics& metrics) {
+    metrics.generation = num_generations;
+    metrics.num_evaluations = promoted_.size();
+    metrics.num_screened = num_screened_;
+    metrics.num_predicted = pending_.size() - promoted_.size() - num_screened_;
+
+    for (auto& counters : simulation_counters_) {
+      metrics.num_steps += counters.num_steps;
+      metrics.num_aborted += counters.num_aborted;
+      counters = SimulationCounters();
+    }
+
+    metrics.cache_hits = cache_.hits() - reported_cache_hits_;
+    metrics.cache_misses = cache_.misses() - reported_cache_misses_;
+    reported_cache_hits_ = cache_.hits();
+    reported_cache_misses_ = cache_.misses();
+
+    if (!generation.empty()) {
+      metrics.best_fitness = std::numeric_limits<double>::infinity();
+      metrics.worst_fitness = -std::numeric_limits<double>::infinity();
+      for (const auto& chromosome : generation) {
+        metrics.best_fitness = std::min(metrics.best_fitness,
+                                        chromosome.fitness());
+        metrics.worst_fitness = std::max(metrics.worst_fitness,
+                                         chromosome.fitness());
+        metrics.mean_fitness += chromosome.fitness();
+      }
+      metrics.mean_fitness /= generation.size();
+
+      for (std::size_t j = 0; j < N; ++j) {
+        double mean = 0.0;
+        for (const auto& chromosome : generation) {
+          mean += chromosome[j].value();
+        }
+        mean /= generation.size();
+
+        double variance = 0.0;
+        for (const auto& chromosome : generation) {
+          double deviation = chromosome[j].value() - mean;
+          variance += deviation * deviation;
+        }
+        variance /= generation.size();
+
+        double deviation = std::sqrt(variance);
+        if (j < constraints_.size() &&
+            constraints_[j].upper > constraints_[j].lower) {
+          deviation /= constraints_[j].upper - constraints_[j].lower;
+        }
+
+        metrics.diversity += deviation / N;
+      }
+    }
+
+    metrics.seconds = timer.Elapsed();
+
+    for (auto* observer : metrics_observers_) {
+      observer->OnMetrics(metrics);
     }
   }
 
-  const std::vector<Parent> SelectParentsFPS(
-      std::vector<Chromosome<T, N>>& generation) {
-    double sum_of_fitness = 0.0;
+  // Encodes everything the generation loop depends on after
+  // `num_generations` generations into `buffer`.
+  void SaveCheckpoint(const std::vector<Chromosome<T, N>>& generation,
+                      const std::size_t num_generations,
+                      std::vector<std::uint8_t>& buffer) const {
+    auto encoder = CheckpointEncoder(buffer);
+    encoder.PutBytes("GACP", 4);
+    encoder.Put(kCheckpointVersion);
+    encoder.Put(static_cast<std::uint32_t>(sizeof(T)));
+    encoder.Put(static_cast<std::uint32_t>(N));
+
+    args_.Save(encoder);
+
+    encoder.Put(static_cast<std::uint64_t>(constraints_.size()));
+    for (const auto& bounds : constraints_) {
+      encoder.Put(bounds.lower);
+      encoder.Put(bounds.upper);
+    }
+
+    encoder.Put(static_cast<std::uint64_t>(num_generations));
+    encoder.Put(static_cast<std::uint64_t>(generation.size()));
     for (const auto& chromosome : generation) {
-      sum_of_fitness += chromosome.fitness();
+      for (const auto& gene : chromosome) {
+        encoder.Put(gene.value());
+      }
+      encoder.Put(chromosome.fitness());
+      encoder.Put(chromosome.selection_pr());
     }
 
-    double prev_pr = 0.0;
-    for (auto& chromosome : generation) {
-      double selection_pr = prev_pr + (chromosome.fitness() / sum_of_fitness);
+    cache_.Save(encoder);
+    surrogate_.Save(encoder);
+    termination_.Save(encoder);
+  }
+
+  void RestoreCheckpoint(CheckpointDecoder& decoder) {
+    char magic[4];
+    decoder.GetBytes(magic, sizeof(magic));
+    if (std::memcmp(magic, "GACP", sizeof(magic)) != 0 ||
+        decoder.Get<std::uint32_t>() != kCheckpointVersion ||
+        decoder.Get<std::uint32_t>() != sizeof(T) ||
+        decoder.Get<std::uint32_t>() != N) {
+      throw std::runtime_error("Incompatible checkpoint");
+    }
+
+    args_.Restore(decoder);
 
-      chromosome.selection_pr() = selection_pr;
-      prev_pr = selection_pr;
+    constraints_.clear();
+    for (auto i = decoder.Get<std::uint64_t>(); i > 0; --i) {
+      auto lower = decoder.Get<T>();
+      auto upper = decoder.Get<T>();
+      constraints_.push_back(typename Gene<T>::Bounds(lower, upper));
     }
 
-    std::sort(generation.begin(), generation.end(), CompareSelectionPr());
+    resumed_num_generations_ = decoder.Get<std::uint64_t>();
+    resumed_generation_.clear();
+    for (auto i = decoder.Get<std::uint64_t>(); i > 0; --i) {
+      auto chromosome = Chromosome<T, N>();
+      for (auto& gene : chromosome) {
+        gene.value() = decoder.Get<T>();
+      }
+      chromosome.fitness() = decoder.Get<double>();
+      chromosome.selection_pr() = decoder.Get<double>();
+      resumed_generation_.push_back(chromosome);
+    }
 
-    auto parents = std::vector<Parent>((generation.size() - kNumSurvivors) / 2);
-    for (auto& parent : parents) {
-      parent = SelectParent(generation);
+    if (resumed_generation_.empty()) {
+      throw std::runtime_error("Checkpoint without a population");
     }
 
-    return parents;
+    cache_.Restore(decoder);
+    surrogate_.Restore(decoder);
+    termination_.Restore(decoder);
+
+    resumed_ = true;
   }
 
-  const Parent SelectParent(const std::vector<Chromosome<T, N>>& generation) {
-    auto parent = Parent();
-    auto dis = std::uniform_real_distribution<>();
+  // Resolves what it can from the fitness cache and simulates the rest.
+  // Every fitness above `survivor_bound` is censored, see Censor, and
+  // estimates end up ranked behind it, see EvaluatePending.
+  void EvaluateFitness(std::vector<Chromosome<T, N>>& generation,
+                       const double cost_bound =
+                           std::numeric_limits<double>::infinity(),
+                       const double survivor_bound =
+                           std::numeric_limits<double>::infinity()) {
+    pending_.clear();
+    duplicates_.clear();
 
-    for (const auto& chromosome : generation) {
-      if (dis(mt_) < chromosome.selection_pr()) {
-        if (!parent.first) {
-          parent.first = &chromosome;
-        } else {
-          parent.second = &chromosome;
+    for (auto& chromosome : generation) {
+      if (!cache_.enabled()) {
+        pending_.push_back(&chromosome);
+        continue;
+      }
+
+      // Looked up against the survivor bound rather than the cost bound, so
+      // that estimates are reused alike with and without bounded evaluation.
+      auto lookup = cache_.Find(chromosome, survivor_bound, pending_.size());
+      switch (lookup.status) {
+        case FitnessCache<T, N>::Lookup::Status::kHit:
+          chromosome.fitness() = Censor(lookup.fitness, survivor_bound);
           break;
+        case FitnessCache<T, N>::Lookup::Status::kPending:
+          duplicates_.push_back(std::make_pair(&chromosome, lookup.pending));
+          break;
+        case FitnessCache<T, N>::Lookup::Status::kMiss:
+          pending_.push_back(&chromosome);
+          break;
+      }
+    }
+
+    EvaluatePending(cost_bound, survivor_bound);
+    termination_.AddEvaluations(promoted_.size());
+
+    // The screened and predicted chromosomes were stored as estimates
+    // first; their entries are only overwritten if they were also promoted.
+    if (cache_.enabled()) {
+      if (promoted_.size() < pending_.size()) {
+        for (const auto* chromosome : pending_) {
+          cache_.StoreEstimate(*chromosome, chromosome->fitness());
         }
       }
+
+      for (const auto* chromosome : promoted_) {
+        cache_.Store(*chromosome, chromosome->fitness(), cost_bound);
+      }
     }
 
-    return parent;
+    for (const auto& [chromosome, pending] : duplicates_) {
+      chromosome->fitness() = pending_[pending]->fitness();
+    }
   }
 
-  const std::vector<Chromosome<T, N>> WholeArithmeticCrossover(
-      const std::vector<Parent>& parents) {
-    auto offspring = std::vector<Chromosome<T, N>>();
-    auto dis = std::uniform_real_distribution<>();
+  // Evaluates the pending chromosomes. The surrogate and then screening, when
+  // enabled, each keep the most promising chromosomes at the front of
+  // `promoted_` and leave the others behind with an estimated fitness. Leaves
+  // the chromosomes evaluated at full fidelity in `promoted_`. Estimates are
+  // raised strictly above both the worst promoted chromosome and
+  // `survivor_bound`, so that they can neither survive nor be the solution.
+  void EvaluatePending(const double cost_bound, const double survivor_bound) {
+    promoted_.assign(pending_.begin(), pending_.end());
+
+    auto num_candidates = PredictFitness();
+
+    auto num_promoted = num_candidates;
+    if (supports_screening() && args_.screening_fraction > 0.0 &&
+        num_candidates > 0) {
+      // At least as many as survive, so that no survivor is an estimate.
+      num_promoted = std::clamp(
+          static_cast<std::size_t>(
+              std::ceil(args_.screening_fraction * num_candidates)),
+          std::min(kNumSurvivors, num_candidates), num_candidates);
+    }
+
+    if (num_promoted < num_candidates) {
+      EvaluateBatches(promoted_.data(), num_candidates,
+                      [this, cost_bound](Chromosome<T, N>* const* chromosomes,
+                                         const std::size_t count,
+                                         const std::size_t worker) {
+                        ScreenBatch(chromosomes, count, worker, cost_bound);
+                      });
+      for (std::size_t i = 0; i < num_candidates; ++i) {
+        promoted_[i]->fitness() =
+            Censor(promoted_[i]->fitness(), survivor_bound);
+      }
+
+      std::nth_element(promoted_.begin(), promoted_.begin() + num_promoted,
+                       promoted_.begin() + num_candidates,
+                       [](const Chromosome<T, N>* c1,
+                          const Chromosome<T, N>* c2) {
+                         return c1->fitness() < c2->fitness();
+                       });
+    }
+
+    num_screened_ = num_candidates - num_promoted;
+
+    EvaluateBatches(promoted_.data(), num_promoted,
+                    [this, cost_bound](Chromosome<T, N>* const* chromosomes,
+                                       const std::size_t count,
+                                       const std::size_t worker) {
+                      FitnessBatch(chromosomes, count, worker, cost_bound);
+                    });
+    for (std::size_t i = 0; i < num_promoted; ++i) {
+      promoted_[i]->fitness() = Censor(promoted_[i]->fitness(), survivor_bound);
+    }
+
+    if (args_.surrogate_fraction > 0.0) {
+      for (std::size_t i = 0; i < num_promoted; ++i) {
+        surrogate_.Add(*promoted_[i], promoted_[i]->fitness());
+      }
+    }
+
+    if (num_promoted < promoted_.size()) {
+      auto worst = -std::numeric_limits<double>::infinity();
+      for (std::size_t i = 0; i < num_promoted; ++i) {
+        worst = std::max(worst, promoted_[i]->fitness());
+      }
+      if (survivor_bound < std::numeric_limits<double>::infinity()) {
+        worst = std::max(worst, survivor_bound);
+      }
+
+      auto floor =
+          std::nextafter(worst, std::numeric_limits<double>::infinity());
+      for (std::size_t i = num_promoted; i < promoted_.size(); ++i) {
+        promoted_[i]->fitness() = Censor(
+            std::max(promoted_[i]->fitness(), floor), survivor_bound);
+      }
+
+      promoted_.resize(num_promoted);
+    }
+  }
+
+  // Simulates the best chromosome of `generation` at full fidelity until one
+  // keeps its fitness, so that an estimate, whether fresh or from the cache,
+  // is never returned as the solution.
+  void VerifyBest(std::vector<Chromosome<T, N>>& generation) {
+    for (std::size_t i = 0; i < generation.size(); ++i) {
+      auto& best = *std::min_element(generation.begin(), generation.end(),
+                                     CompareFitness());
+      auto fitness =
+          Fitness(best, 0, std::numeric_limits<double>::infinity());
+      if (fitness == best.fitness()) {
+        return;
+      }
+      best.fitness() = fitness;
+    }
+  }
+
+  // Sets the fitness of every chromosome of `promoted_` to its surrogate
+  // prediction and moves those worth simulating to the front: mostly the
+  // best predicted, plus some of those furthest from the archive. Returns
+  // how many are worth simulating, which is all of them while the surrogate
+  // is disabled or still learning.
+  const std::size_t PredictFitness() {
+    auto size = promoted_.size();
+    if (args_.surrogate_fraction <= 0.0 || size == 0 ||
+        surrogate_.size() < args_.population_size) {
+      return size;
+    }
+
+    // At least as many as survive, so that no survivor is a prediction.
+    auto num_simulated = std::clamp(
+        static_cast<std::size_t>(std::ceil(args_.surrogate_fraction * size)),
+        std::min(kNumSurvivors, size), size);
+    if (num_simulated == size) {
+      return size;
+    }
+
+    surrogate_distances_.resize(size);
+    for (std::size_t i = 0; i < size; ++i) {
+      auto prediction = surrogate_.Predict(*promoted_[i]);
+      promoted_[i]->fitness() = prediction.fitness;
+      surrogate_distances_[i] =
+          std::make_pair(prediction.distance, promoted_[i]);
+    }
+
+    auto num_explored = static_cast<std::size_t>(
+        std::floor(kSurrogateExploration * num_simulated));
+    auto num_best = num_simulated - num_explored;
+
+    auto begin = surrogate_distances_.begin();
+    std::nth_element(begin, begin + num_best, surrogate_distances_.end(),
+                     [](const auto& c1, const auto& c2) {
+                       return c1.second->fitness() < c2.second->fitness();
+                     });
+    std::nth_element(begin + num_best, begin + num_simulated,
+                     surrogate_distances_.end(),
+                     [](const auto& c1, const auto& c2) {
+                       return c1.first > c2.first;
+                     });
+
+    for (std::size_t i = 0; i < size; ++i) {
+      promoted_[i] = surrogate_distances_[i].second;
+    }
+
+    return num_simulated;
+  }
+
+  // Calls `evaluate(chromosomes, count, worker)` on consecutive batches of
+  // the `count` chromosomes, spread over the workers.
+  template <typename Evaluate>
+  void EvaluateBatches(Chromosome<T, N>* const* chromosomes,
+                       const std::size_t count, Evaluate&& evaluate) {
+    if (count == 0) {
+      return;
+    }
+
+    // Batches are capped so that every worker still gets a share of a small
+    // generation.
+    auto num_workers = std::min(this->num_workers(), count);
+    auto batch_size = std::clamp((count + num_workers - 1) / num_workers,
+                                 std::size_t(1),
+                                 std::max(std::size_t(1), this->batch_size()));
+    auto num_batches = (count + batch_size - 1) / batch_size;
+    num_workers = std::min(num_workers, num_batches);
+
+    auto evaluate_batch = [&evaluate, chromosomes, count, batch_size](
+                              const std::size_t batch,
+                              const std::size_t worker) {
+      auto first = batch * batch_size;
+      evaluate(chromosomes + first, std::min(batch_size, count - first),
+               worker);
+    };
+
+    if (num_workers <= 1) {
+      for (std::size_t batch = 0; batch < num_batches; ++batch) {
+        evaluate_batch(batch, 0);
+      }
+
+      return;
+    }
+
+    // Batches are handed out one at a time so that slow evaluations do not
+    // stall a statically assigned chunk. Every fitness only depends on its own
+    // chromosome, so the results match the serial path exactly.
+    auto next = std::atomic<std::size_t>(0);
+    auto evaluate_batches = [&evaluate_batch, &next,
+                             num_batches](const std::size_t worker) {
+      for (auto batch = next.fetch_add(1, std::memory_order_relaxed);
+           batch < num_batches;
+           batch = next.fetch_add(1, std::memory_order_relaxed)) {
+        evaluate_batch(batch, worker);
+      }
+    };
+
+    if (executor_) {
+      executor_->Run(num_workers, evaluate_batches);
+      return;
+    }
+
+    auto workers = std::vector<std::jthread>();
+    workers.reserve(num_workers - 1);
+    for (std::size_t worker = 1; worker < num_workers; ++worker) {
+      workers.emplace_back(evaluate_batches, worker);
+    }
+
+    evaluate_batches(0);
+  }
+
+  // Draws the parent pairs for the offspring of a generation with the
+  // configured selection scheme. Both parents are always set and differ
+  // whenever the scheme gives more than one chromosome a chance.
+  void SelectParents(std::vector<Chromosome<T, N>>& generation,
+                     std::vector<Parent>& parents) {
+    parents.resize(generation.size() < kNumSurvivors
+                       ? 0
+                       : (generation.size() - kNumSurvivors) / 2);
+    if (parents.empty()) {
+      return;
+    }
+
+    PrepareSelection(generation);
+
+    for (std::size_t i = 0; i < parents.size(); ++i) {
+      auto random = OffspringStream(Stream::kSelection, i);
+      auto first = SelectIndex(generation, random);
+      auto second = SelectIndex(generation, random);
+      for (std::size_t j = 0; second == first && j < kMaxParentRedraws; ++j) {
+        second = SelectIndex(generation, random);
+      }
+
+      parents[i] = Parent(&generation[first], &generation[second]);
+    }
+  }
+
+  // Builds the roulette wheel of the fitness proportionate and rank schemes
+  // and records each chromosome's selection probability.
+  void PrepareSelection(std::vector<Chromosome<T, N>>& generation) {
+    auto size = generation.size();
+    selection_weights_.resize(size);
+
+    switch (args_.selection) {
+      case Selection::kFitnessProportionate:
+        for (std::size_t i = 0; i < size; ++i) {
+          selection_weights_[i] = generation[i].fitness();
+        }
+        break;
+      case Selection::kRank:
+        selection_order_.resize(size);
+        for (std::size_t i = 0; i < size; ++i) {
+          selection_order_[i] = i;
+        }
+        std::sort(selection_order_.begin(), selection_order_.end(),
+                  [&generation](const std::size_t i, const std::size_t j) {
+                    return generation[i].fitness() < generation[j].fitness();
+                  });
+
+        for (std::size_t rank = 0; rank < size; ++rank) {
+          selection_weights_[selection_order_[rank]] =
+              static_cast<double>(size - rank);
+        }
+        break;
+      case Selection::kTournament:
+        return;
+    }
+
+    double sum_of_weights = 0.0;
+    for (auto weight : selection_weights_) {
+      sum_of_weights += weight;
+    }
+    for (std::size_t i = 0; i < size; ++i) {
+      generation[i].selection_pr() =
+          sum_of_weights > 0.0 ? selection_weights_[i] / sum_of_weights
+                               : 1.0 / size;
+    }
+
+    selection_table_.Build(selection_weights_);
+  }
+
+  // O(1) for the roulette wheel schemes, O(tournament_size) for tournaments.
+  const std::size_t SelectIndex(
+      const std::vector<Chromosome<T, N>>& generation, RandomStream& random) {
+    if (args_.selection != Selection::kTournament) {
+      return selection_table_.Sample(random);
+    }
+
+    auto dis =
+        std::uniform_int_distribution<std::size_t>(0, generation.size() - 1);
+    auto winner = dis(random);
+    for (std::size_t i = 1; i < args_.tournament_size; ++i) {
+      auto contender = dis(random);
+      if (generation[contender].fitness() < generation[winner].fitness()) {
+        winner = contender;
+      }
+    }
 
-    for (const auto& parent : parents) {
-      auto& first_parent = *parent.first;
-      auto& second_parent = *parent.second;
+    return winner;
+  }
+
+  // Writes the two children of every pair of `parents` to consecutive
+  // chromosomes of `offspring`, starting at `first`.
+  void WholeArithmeticCrossover(const std::vector<Parent>& parents,
+                                std::vector<Chromosome<T, N>>& offspring,
+                                const std::size_t first) {
+    auto dis = std::uniform_real_distribution<>();
 
-      if (dis(mt_) < args_.crossover_pr) {
-        auto first_child = Chromosome<T, N>(constraints_);
-        auto second_child = Chromosome<T, N>(constraints_);
+    auto child = offspring.begin() + first;
+    for (std::size_t i = 0; i < parents.size(); ++i) {
+      auto& first_parent = *parents[i].first;
+      auto& second_parent = *parents[i].second;
+      auto& first_child = *child++;
+      auto& second_child = *child++;
 
+      auto random = OffspringStream(Stream::kCrossover, i);
+      if (dis(random) < args_.crossover_pr) {
         for (std::size_t j = 0; j < N; ++j) {
           first_child[j].value() = (kAlpha * first_parent[j].value()) +
                                    ((1.0 - kAlpha) * second_parent[j].value());
@@ -226,30 +1138,109 @@ class Procedure {
                                     (kAlpha * second_parent[j].value());
         }
 
-        offspring.push_back(first_child);
-        offspring.push_back(second_child);
+        first_child.fitness() = second_child.fitness() = 0.0;
+        first_child.selection_pr() = second_child.selection_pr() = 0.0;
       } else {
-        offspring.push_back(first_parent);
-        offspring.push_back(second_parent);
+        first_child = first_parent;
+        second_child = second_parent;
       }
     }
-
-    return offspring;
   }
 
-  void UniformMutation(std::vector<Chromosome<T, N>>& offspring) {
+  // Mutates the chromosomes of `offspring` from `first` on. Every chromosome
+  // draws from its own stream, so they could be mutated in any order.
+  void UniformMutation(std::vector<Chromosome<T, N>>& offspring,
+                       const std::size_t first = 0) {
     auto dis = std::uniform_real_distribution<>();
 
-    for (auto& chromosome : offspring) {
-      if (dis(mt_) < args_.mutation_pr) {
-        chromosome.randomize();
+    for (auto i = first; i < offspring.size(); ++i) {
+      auto random = OffspringStream(Stream::kMutation, i);
+      if (dis(random) < args_.mutation_pr) {
+        offspring[i].randomize(random, constraints_);
       }
     }
   }
 
+ private:
+  // The operators that draw random numbers, each from streams of its own.
+  enum Stream : std::uint32_t {
+    kInitialization,
+    kSelection,
+    kCrossover,
+    kMutation,
+  };
+
+  // The stream `stream` draws the `index`th parent pair or child of the
+  // generation being bred from.
+  constexpr const RandomStream OffspringStream(const Stream stream,
+                                               const std::size_t index) const {
+    return RandomStream(args_.seed, offspring_generation_, stream, index);
+  }
+
+  static const std::uint64_t RandomSeed() {
+    auto device = std::random_device();
+    std::uint64_t seed = 0;
+    while (seed == 0) {
+      seed = (std::uint64_t(device()) << 32) | device();
+    }
+
+    return seed;
+  }
+
   Args args_;
   std::vector<typename Gene<T>::Bounds> constraints_;
-  std::mt19937_64 mt_;
+  // The number of the generation the operators are breeding.
+  std::size_t offspring_generation_;
+
+  FitnessCache<T, N> cache_;
+
+  // Chromosomes of the current evaluation that need simulating, those that
+  // duplicate one of them and those that were simulated at full fidelity.
+  std::vector<Chromosome<T, N>*> pending_;
+  std::vector<std::pair<Chromosome<T, N>*, std::size_t>> duplicates_;
+  std::vector<Chromosome<T, N>*> promoted_;
+  std::size_t num_screened_ = 0;
+
+  // Archive of simulated chromosomes, and each pending chromosome with its
+  // distance to the archive.
+  Surrogate<T, N> surrogate_;
+  std::vector<std::pair<double, Chromosome<T, N>*>> surrogate_distances_;
+
+  std::string log_file_name_;
+  LogFormat log_format_;
+  LogSink* log_sink_;
+  Executor* executor_;
+  std::atomic<bool> stop_requested_;
+
+  // Per-worker simulation costs, padded so that workers do not share cache
+  // lines.
+  struct alignas(64) SimulationCounters {
+    std::size_t num_steps = 0;
+    std::size_t num_aborted = 0;
+  };
+
+  // Reused by every selection.
+  AliasTable selection_table_;
+  std::vector<double> selection_weights_;
+  std::vector<std::size_t> selection_order_;
+
+  std::string checkpoint_file_name_;
+  std::size_t checkpoint_interval_;
+  std::vector<std::uint8_t> checkpoint_buffer_;
+
+  // The state restored by Resume for the next Start.
+  bool resumed_;
+  std::size_t resumed_num_generations_;
+  std::vector<Chromosome<T, N>> resumed_generation_;
+
+  TerminationRules termination_rules_;
+  TerminationMonitor termination_;
+  unsigned termination_reason_;
+
+  std::vector<MetricsObserver*> metrics_observers_;
+  std::vector<SimulationCounters> simulation_counters_;
+  std::size_t reported_cache_hits_ = 0;
+  std::size_t reported_cache_misses_ = 0;
 };
 
 }  // namespace ga
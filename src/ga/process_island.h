@@ -0,0 +1,355 @@
+#ifndef GA_PROCESS_ISLAND_H_
+#define GA_PROCESS_ISLAND_H_
+
+#include <poll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ga/island_model.h"
+#include "ga/wire.h"
+
+namespace ga {
+
+// An island of a multi-process island model. It runs the procedure P in this
+// process and talks to a Coordinator over a Unix domain socket: it reports
+// its best fitness every generation, sends its best chromosomes every
+// `migration_interval` generations, and accepts migrants and stop requests
+// relayed by the coordinator.
+template <typename P>
+class RemoteIsland : public P {
+ public:
+  using chromosome_type = typename P::chromosome_type;
+  using bounds_type = typename P::bounds_type;
+  using MigrationArgs = typename IslandModel<P>::Args;
+
+  RemoteIsland(const std::string& socket_path, const MigrationArgs& migration,
+               const typename P::Args& args,
+               const std::vector<bounds_type>& constraints)
+      : P(args, constraints),
+        socket_(wire::Connect(socket_path)),
+        migration_(migration) {
+    this->log_file_name().clear();
+  }
+
+  virtual ~RemoteIsland() = default;
+
+  // Runs the procedure and reports its solution to the coordinator.
+  const chromosome_type Run() {
+    auto solution = this->Start();
+
+    auto message = wire::Message(wire::Message::Type::kResult);
+    message.payload.resize(Codec::kEncodedSize);
+    Codec::Encode(solution, message.payload.data());
+    wire::Send(socket_, message);
+
+    socket_.close();
+
+    return solution;
+  }
+
+ protected:
+  void OnGeneration(const std::size_t num_generations,
+                    std::vector<chromosome_type>& generation) override {
+    P::OnGeneration(num_generations, generation);
+
+    auto compare = [](const chromosome_type& c1, const chromosome_type& c2) {
+      return c1.fitness() < c2.fitness();
+    };
+
+    auto message = wire::Message();
+    while (wire::Readable(socket_)) {
+      if (!wire::Receive(socket_, message)) {
+        this->RequestStop();
+        break;
+      }
+
+      if (message.type == wire::Message::Type::kStop) {
+        this->RequestStop();
+      } else if (message.type == wire::Message::Type::kMigrants) {
+        for (std::size_t offset = 0;
+             offset + Codec::kEncodedSize <= message.payload.size();
+             offset += Codec::kEncodedSize) {
+          auto migrant = Codec::Decode(&message.payload[offset]);
+          auto worst =
+              std::max_element(generation.begin(), generation.end(), compare);
+          if (worst != generation.end() &&
+              migrant.fitness() < worst->fitness()) {
+            *worst = migrant;
+          }
+        }
+      }
+    }
+
+    auto best = std::min_element(generation.begin(), generation.end(), compare);
+    if (best == generation.end()) {
+      return;
+    }
+
+    message = wire::Message(wire::Message::Type::kProgress, 0,
+                            static_cast<std::uint32_t>(num_generations));
+    message.payload.resize(sizeof(double));
+    auto fitness = best->fitness();
+    std::memcpy(message.payload.data(), &fitness, sizeof(double));
+    if (!wire::Send(socket_, message)) {
+      this->RequestStop();
+      return;
+    }
+
+    if (migration_.migration_interval == 0 ||
+        num_generations % migration_.migration_interval != 0) {
+      return;
+    }
+
+    auto num_migrants = std::min(migration_.num_migrants, generation.size());
+    std::partial_sort(generation.begin(), generation.begin() + num_migrants,
+                      generation.end(), compare);
+
+    message = wire::Message(wire::Message::Type::kMigrants, 0,
+                            static_cast<std::uint32_t>(num_generations));
+    message.payload.resize(num_migrants * Codec::kEncodedSize);
+    for (std::size_t i = 0; i < num_migrants; ++i) {
+      Codec::Encode(generation[i], &message.payload[i * Codec::kEncodedSize]);
+    }
+    if (!wire::Send(socket_, message)) {
+      this->RequestStop();
+    }
+  }
+
+ private:
+  using Codec = wire::ChromosomeCodec<chromosome_type>;
+
+  wire::Socket socket_;
+  MigrationArgs migration_;
+};
+
+// Coordinates RemoteIsland processes: relays migrants around the ring of
+// islands, records the global best fitness of every generation and collects
+// the final solutions. Once any island reports `target_fitness` or better,
+// every island is asked to stop. Messages to the islands are queued and
+// written without blocking, so an island that falls behind never stalls the
+// others; migrants for an island with kMaxQueuedBytes still unread are
+// dropped.
+template <typename C>
+class Coordinator {
+ public:
+  static constexpr const std::size_t kMaxQueuedBytes = 1 << 20;
+
+  // How long Start waits for the islands to connect.
+  static constexpr const std::chrono::milliseconds kAcceptTimeout =
+      std::chrono::milliseconds(10000);
+
+  // Starts listening immediately so that islands may be launched right after
+  // construction.
+  Coordinator(const std::string& socket_path, const std::size_t num_islands,
+              const double target_fitness =
+                  -std::numeric_limits<double>::infinity())
+      : socket_path_(socket_path),
+        num_islands_(std::max(std::size_t(1), num_islands)),
+        target_fitness_(target_fitness),
+        listener_(wire::Listen(socket_path, static_cast<int>(num_islands_))),
+        log_file_name_("fitnesses.csv") {}
+
+  ~Coordinator() { ::unlink(socket_path_.c_str()); }
+
+  constexpr const std::size_t num_islands() const { return num_islands_; }
+
+  // The best fitness reported by any island for each generation, indexed
+  // from generation one.
+  constexpr const std::vector<double>& best_fitnesses() const {
+    return best_fitnesses_;
+  }
+
+  constexpr const std::vector<C>& solutions() const { return solutions_; }
+
+  // The per-generation best fitness log. An empty name disables it.
+  const std::string& log_file_name() const { return log_file_name_; }
+  std::string& log_file_name() { return log_file_name_; }
+
+  // Serves the islands until every one has disconnected and returns the
+  // global best solution. Islands that have not connected within
+  // kAcceptTimeout, for instance because their process died, are left out
+  // of the ring. Throws std::runtime_error if none connected.
+  const C Start() {
+    auto islands = std::vector<wire::Socket>();
+    auto deadline = std::chrono::steady_clock::now() + kAcceptTimeout;
+    while (islands.size() < num_islands_) {
+      auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(
+                         deadline - std::chrono::steady_clock::now())
+                         .count();
+      if (timeout <= 0) {
+        break;
+      }
+      if (wire::Readable(listener_, static_cast<int>(timeout))) {
+        islands.push_back(wire::Accept(listener_));
+      }
+    }
+
+    listener_.close();
+    ::unlink(socket_path_.c_str());
+
+    if (islands.empty()) {
+      throw std::runtime_error("No island connected");
+    }
+
+    auto num_connected = islands.size();
+    outboxes_.assign(num_connected, std::vector<std::uint8_t>());
+    auto poll_fds = std::vector<pollfd>(num_connected);
+    auto stopped = false;
+    auto num_open = num_connected;
+    auto message = wire::Message();
+
+    while (num_open > 0) {
+      for (std::size_t i = 0; i < num_connected; ++i) {
+        poll_fds[i].fd = islands[i].fd();
+        poll_fds[i].events = outboxes_[i].empty() ? POLLIN : POLLIN | POLLOUT;
+        poll_fds[i].revents = 0;
+      }
+
+      if (::poll(poll_fds.data(), poll_fds.size(), -1) < 0) {
+        continue;
+      }
+
+      for (std::size_t i = 0; i < num_connected; ++i) {
+        if (!islands[i].is_open()) {
+          continue;
+        }
+
+        if ((poll_fds[i].revents & POLLOUT) != 0) {
+          Flush(islands[i], outboxes_[i]);
+        }
+        if ((poll_fds[i].revents & (POLLIN | POLLHUP | POLLERR)) == 0) {
+          continue;
+        }
+
+        if (!wire::Receive(islands[i], message)) {
+          islands[i].close();
+          outboxes_[i].clear();
+          --num_open;
+          continue;
+        }
+
+        message.island = static_cast<std::uint16_t>(i);
+        switch (message.type) {
+          case wire::Message::Type::kProgress:
+            if (message.payload.size() == sizeof(double)) {
+              double fitness;
+              std::memcpy(&fitness, message.payload.data(), sizeof(double));
+              RecordProgress(message.generation, fitness);
+
+              if (!stopped && fitness <= target_fitness_) {
+                stopped = true;
+                auto stop = wire::Message(wire::Message::Type::kStop);
+                for (std::size_t j = 0; j < num_connected; ++j) {
+                  Post(islands[j], outboxes_[j], stop);
+                }
+              }
+            }
+            break;
+          case wire::Message::Type::kMigrants: {
+            auto neighbour = (i + 1) % num_connected;
+            if (neighbour != i &&
+                outboxes_[neighbour].size() < kMaxQueuedBytes) {
+              Post(islands[neighbour], outboxes_[neighbour], message);
+            }
+            break;
+          }
+          case wire::Message::Type::kResult:
+            if (message.payload.size() == Codec::kEncodedSize) {
+              solutions_.push_back(Codec::Decode(message.payload.data()));
+            }
+            break;
+          case wire::Message::Type::kStop:
+          case wire::Message::Type::kJob:
+          case wire::Message::Type::kError:
+            break;
+        }
+      }
+    }
+
+    WriteLog();
+
+    if (solutions_.empty()) {
+      return C();
+    }
+
+    return *std::min_element(
+        solutions_.begin(), solutions_.end(),
+        [](const C& c1, const C& c2) { return c1.fitness() < c2.fitness(); });
+  }
+
+ private:
+  using Codec = wire::ChromosomeCodec<C>;
+
+  void RecordProgress(const std::size_t generation, const double fitness) {
+    if (generation == 0) {
+      return;
+    }
+
+    if (best_fitnesses_.size() < generation) {
+      best_fitnesses_.resize(generation,
+                             std::numeric_limits<double>::infinity());
+    }
+
+    best_fitnesses_[generation - 1] =
+        std::min(best_fitnesses_[generation - 1], fitness);
+  }
+
+  // Queues `message` for `island` and writes what the socket takes.
+  static void Post(const wire::Socket& island,
+                   std::vector<std::uint8_t>& outbox,
+                   const wire::Message& message) {
+    if (island.is_open()) {
+      wire::Encode(message, outbox);
+      Flush(island, outbox);
+    }
+  }
+
+  // Writes what the socket takes of `outbox` without blocking. An island
+  // that has gone away is noticed when its socket is next read.
+  static void Flush(const wire::Socket& island,
+                    std::vector<std::uint8_t>& outbox) {
+    auto written = wire::TrySend(island, outbox.data(), outbox.size());
+    if (written < 0) {
+      outbox.clear();
+    } else {
+      outbox.erase(outbox.begin(), outbox.begin() + written);
+    }
+  }
+
+  void WriteLog() const {
+    if (log_file_name_.empty()) {
+      return;
+    }
+
+    auto csv_file = std::ofstream(log_file_name_.c_str(), std::fstream::out);
+    csv_file << "generation,fitness\n";
+    for (std::size_t i = 0; i < best_fitnesses_.size(); ++i) {
+      csv_file << i + 1 << "," << best_fitnesses_[i] << "\n";
+    }
+  }
+
+  std::string socket_path_;
+  std::size_t num_islands_;
+  double target_fitness_;
+  wire::Socket listener_;
+  std::string log_file_name_;
+
+  // The bytes still to be written to every island.
+  std::vector<std::vector<std::uint8_t>> outboxes_;
+
+  std::vector<double> best_fitnesses_;
+  std::vector<C> solutions_;
+};
+
+}  // namespace ga
+
+#endif  // GA_PROCESS_ISLAND_H_
@@ -0,0 +1,111 @@
+#ifndef GA_RANDOM_H_
+#define GA_RANDOM_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace ga {
+
+// A counter-based random stream: the Philox4x32-10 block cipher of Salmon et
+// al., "Parallel random numbers: as easy as 1, 2, 3" (SC 2011), applied to
+// the counter (block, index, generation, stream) under a key taken from the
+// seed. Any (seed, generation, stream, index) names an independent stream
+// that costs nothing to create, needs no state beyond its block counter and
+// gives the same numbers on any thread and in any order. Meets
+// UniformRandomBitGenerator, two 64-bit numbers per block.
+class RandomStream {
+ public:
+  using result_type = std::uint64_t;
+
+  constexpr RandomStream(const std::uint64_t seed,
+                         const std::uint64_t generation = 0,
+                         const std::uint32_t stream = 0,
+                         const std::uint64_t index = 0)
+      : key_{static_cast<std::uint32_t>(seed),
+             static_cast<std::uint32_t>(seed >> 32)},
+        counter_{0, static_cast<std::uint32_t>(index),
+                 static_cast<std::uint32_t>(generation), stream},
+        block_(),
+        next_(kNumOutputs) {}
+
+  constexpr ~RandomStream() = default;
+
+  static constexpr const result_type min() { return 0; }
+  static constexpr const result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  constexpr const result_type operator()() {
+    if (next_ == kNumOutputs) {
+      block_ = Block(counter_, key_);
+      ++counter_[0];
+      next_ = 0;
+    }
+
+    auto low = block_[2 * next_];
+    auto high = block_[2 * next_ + 1];
+    ++next_;
+
+    return (static_cast<std::uint64_t>(high) << 32) | low;
+  }
+
+  // The Philox4x32-10 bijection of `counter` under `key`.
+  static constexpr const std::array<std::uint32_t, 4> Block(
+      std::array<std::uint32_t, 4> counter,
+      std::array<std::uint32_t, 2> key) {
+    for (std::size_t round = 0; round < kNumRounds; ++round) {
+      auto product0 = std::uint64_t(kMultiplier0) * counter[0];
+      auto product1 = std::uint64_t(kMultiplier1) * counter[2];
+
+      counter = {static_cast<std::uint32_t>(product1 >> 32) ^ counter[1] ^
+                     key[0],
+                 static_cast<std::uint32_t>(product1),
+                 static_cast<std::uint32_t>(product0 >> 32) ^ counter[3] ^
+                     key[1],
+                 static_cast<std::uint32_t>(product0)};
+
+      key[0] += kWeyl0;
+      key[1] += kWeyl1;
+    }
+
+    return counter;
+  }
+
+ private:
+  static constexpr const std::size_t kNumRounds = 10;
+  static constexpr const std::size_t kNumOutputs = 2;
+
+  static constexpr const std::uint32_t kMultiplier0 = 0xD2511F53;
+  static constexpr const std::uint32_t kMultiplier1 = 0xCD9E8D57;
+  static constexpr const std::uint32_t kWeyl0 = 0x9E3779B9;
+  static constexpr const std::uint32_t kWeyl1 = 0xBB67AE85;
+
+  std::array<std::uint32_t, 2> key_;
+  std::array<std::uint32_t, 4> counter_;
+  std::array<std::uint32_t, 4> block_;
+  std::size_t next_;
+};
+
+static_assert(RandomStream::Block({0, 0, 0, 0}, {0, 0}) ==
+                  std::array<std::uint32_t, 4>{0x6627e8d5, 0xe169c58d,
+                                               0xbc57ac4c, 0x9b00dbd8},
+              "Philox4x32-10 known answer");
+
+// The seed of the `index`th of several runs sharing `seed`, such as the
+// islands of an island model. Derived seeds are never zero, the seed that
+// asks for a random one, unless `seed` is.
+inline constexpr const std::uint64_t DeriveSeed(const std::uint64_t seed,
+                                                const std::uint64_t index) {
+  if (seed == 0) {
+    return 0;
+  }
+
+  auto derived = RandomStream(seed, 0, ~std::uint32_t(0), index)();
+  return derived != 0 ? derived : 1;
+}
+
+}  // namespace ga
+
+#endif  // GA_RANDOM_H_
@@ -0,0 +1,173 @@
+#ifndef GA_SURROGATE_H_
+#define GA_SURROGATE_H_
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "ga/checkpoint.h"
+#include "ga/chromosome.h"
+#include "ga/gene.h"
+
+namespace ga {
+
+// Predicts fitnesses by k-nearest-neighbour regression over an archive of
+// simulated chromosomes. Genes are scaled by the width of their bounds so that
+// each of them counts alike. The archive is a ring buffer: once it is full
+// every new evaluation replaces the oldest one, so the model follows the
+// population as it converges without ever being refitted.
+template <typename T, std::size_t N>
+class Surrogate {
+ public:
+  static constexpr const std::size_t kDefaultCapacity = 2048;
+  static constexpr const std::size_t kNumNeighbours = 8;
+
+  struct Prediction {
+    constexpr Prediction(const double fitness = 0.0,
+                         const double distance = 0.0)
+        : fitness(fitness), distance(distance) {}
+
+    constexpr ~Prediction() = default;
+
+    double fitness;
+    // The scaled distance to the nearest archived chromosome. The further a
+    // chromosome lies from the archive, the less its prediction is worth.
+    double distance;
+  };
+
+  explicit Surrogate(const std::size_t capacity = kDefaultCapacity)
+      : capacity_(capacity), next_(0) {
+    scales_.fill(1.0);
+    points_.reserve(capacity_);
+  }
+
+  ~Surrogate() = default;
+
+  constexpr const std::size_t size() const { return points_.size(); }
+  constexpr const std::size_t capacity() const { return capacity_; }
+
+  // Scales every gene by the width of its bounds. Genes without bounds keep
+  // their values. Only affects chromosomes added from now on.
+  void set_bounds(const std::vector<typename Gene<T>::Bounds>& bounds) {
+    for (std::size_t j = 0; j < N; ++j) {
+      scales_[j] = j < bounds.size() && bounds[j].upper > bounds[j].lower
+                       ? 1.0 / (bounds[j].upper - bounds[j].lower)
+                       : 1.0;
+    }
+  }
+
+  void Add(const Chromosome<T, N>& chromosome, const double fitness) {
+    if (capacity_ == 0) {
+      return;
+    }
+
+    auto point = Point();
+    point.genes = Scale(chromosome);
+    point.fitness = fitness;
+
+    if (points_.size() < capacity_) {
+      points_.push_back(point);
+    } else {
+      points_[next_] = point;
+      next_ = (next_ + 1) % capacity_;
+    }
+  }
+
+  // The inverse squared distance weighted mean fitness of the nearest
+  // archived chromosomes. A chromosome that is in the archive predicts its
+  // own fitness. The archive must not be empty.
+  const Prediction Predict(const Chromosome<T, N>& chromosome) const {
+    auto genes = Scale(chromosome);
+
+    // The nearest neighbours so far, closest first.
+    auto distances = std::array<double, kNumNeighbours>();
+    auto fitnesses = std::array<double, kNumNeighbours>();
+    distances.fill(std::numeric_limits<double>::infinity());
+
+    for (const auto& point : points_) {
+      double distance = 0.0;
+      for (std::size_t j = 0; j < N; ++j) {
+        double difference = point.genes[j] - genes[j];
+        distance += difference * difference;
+      }
+
+      if (distance >= distances.back()) {
+        continue;
+      }
+
+      auto i = kNumNeighbours - 1;
+      for (; i > 0 && distances[i - 1] > distance; --i) {
+        distances[i] = distances[i - 1];
+        fitnesses[i] = fitnesses[i - 1];
+      }
+      distances[i] = distance;
+      fitnesses[i] = point.fitness;
+    }
+
+    if (distances.front() == 0.0) {
+      return Prediction(fitnesses.front(), 0.0);
+    }
+
+    double weighted_fitness = 0.0;
+    double sum_of_weights = 0.0;
+    for (std::size_t i = 0; i < kNumNeighbours && std::isfinite(distances[i]);
+         ++i) {
+      weighted_fitness += fitnesses[i] / distances[i];
+      sum_of_weights += 1.0 / distances[i];
+    }
+
+    return Prediction(weighted_fitness / sum_of_weights,
+                      std::sqrt(distances.front()));
+  }
+
+  void Save(CheckpointEncoder& encoder) const {
+    encoder.Put(static_cast<std::uint64_t>(capacity_));
+    encoder.Put(scales_);
+    encoder.PutArray(points_.data(), points_.size());
+    encoder.Put(static_cast<std::uint64_t>(next_));
+  }
+
+  void Restore(CheckpointDecoder& decoder) {
+    capacity_ = decoder.Get<std::uint64_t>();
+    scales_ = decoder.Get<std::array<double, N>>();
+    points_ = decoder.GetArray<Point>();
+    next_ = decoder.Get<std::uint64_t>();
+
+    if (points_.size() > capacity_ ||
+        (next_ != 0 && next_ >= points_.size())) {
+      throw std::runtime_error("Corrupt surrogate archive in checkpoint");
+    }
+
+    points_.reserve(capacity_);
+  }
+
+ private:
+  struct Point {
+    std::array<double, N> genes;
+    double fitness;
+  };
+
+  const std::array<double, N> Scale(const Chromosome<T, N>& chromosome) const {
+    auto genes = std::array<double, N>();
+    for (std::size_t j = 0; j < N; ++j) {
+      genes[j] = static_cast<double>(chromosome[j].value()) * scales_[j];
+    }
+
+    return genes;
+  }
+
+  std::size_t capacity_;
+  std::array<double, N> scales_;
+
+  std::vector<Point> points_;
+  // The oldest point, replaced next once the archive is full.
+  std::size_t next_;
+};
+
+}  // namespace ga
+
+#endif  // GA_SURROGATE_H_
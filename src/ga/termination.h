@@ -0,0 +1,217 @@
+#ifndef GA_TERMINATION_H_
+#define GA_TERMINATION_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <string>
+
+#include "ga/checkpoint.h"
+
+namespace ga {
+
+// Optional stopping rules for Procedure::Start. The generation limit of the
+// procedure's Args and stop requests always apply. With Mode::kAny the run
+// stops as soon as one configured rule fires; with Mode::kAll only once every
+// configured rule has fired.
+struct TerminationRules {
+  // Bits identifying the rules that stopped a run.
+  enum Rule : unsigned {
+    kMaxGenerations = 1U << 0,
+    kStopRequested = 1U << 1,
+    kTargetFitness = 1U << 2,
+    kStall = 1U << 3,
+    kMaxEvaluations = 1U << 4,
+    kTimeLimit = 1U << 5,
+  };
+
+  enum class Mode { kAny, kAll };
+
+  // The configured optional rules as a mask of Rule bits.
+  constexpr const unsigned configured() const {
+    return (target_fitness.has_value() ? kTargetFitness : 0U) |
+           (stall_generations != 0 ? kStall : 0U) |
+           (max_evaluations != 0 ? kMaxEvaluations : 0U) |
+           (time_limit.has_value() ? kTimeLimit : 0U);
+  }
+
+  // Names the rules of a mask, joined by '+'.
+  static const std::string Describe(const unsigned rules) {
+    auto description = std::string();
+    auto add = [&description, rules](const Rule rule, const char* name) {
+      if (rules & rule) {
+        description += description.empty() ? name : std::string("+") + name;
+      }
+    };
+
+    add(kMaxGenerations, "max_generations");
+    add(kStopRequested, "stop_requested");
+    add(kTargetFitness, "target_fitness");
+    add(kStall, "stall");
+    add(kMaxEvaluations, "max_evaluations");
+    add(kTimeLimit, "time_limit");
+
+    return description.empty() ? "none" : description;
+  }
+
+  friend std::ostream& operator<<(std::ostream& os,
+                                  const TerminationRules& rules) {
+    os << "Stop when:\t";
+    if (rules.configured() != 0) {
+      os << (rules.mode == Mode::kAll ? "all" : "any") << " of "
+         << Describe(rules.configured()) << ", or ";
+    }
+    os << Describe(kMaxGenerations);
+
+    return os;
+  }
+
+  void Save(CheckpointEncoder& encoder) const {
+    encoder.Put(mode);
+    encoder.Put(static_cast<std::uint8_t>(target_fitness.has_value()));
+    encoder.Put(target_fitness.value_or(0.0));
+    encoder.Put(static_cast<std::uint64_t>(stall_generations));
+    encoder.Put(static_cast<std::uint64_t>(max_evaluations));
+    encoder.Put(static_cast<std::uint8_t>(time_limit.has_value()));
+    encoder.Put(time_limit.value_or(std::chrono::duration<double>()).count());
+  }
+
+  void Restore(CheckpointDecoder& decoder) {
+    mode = decoder.Get<Mode>();
+    auto has_target_fitness = decoder.Get<std::uint8_t>() != 0;
+    auto target = decoder.Get<double>();
+    target_fitness = has_target_fitness ? std::optional<double>(target)
+                                        : std::nullopt;
+    stall_generations = decoder.Get<std::uint64_t>();
+    max_evaluations = decoder.Get<std::uint64_t>();
+    auto has_time_limit = decoder.Get<std::uint8_t>() != 0;
+    auto limit = std::chrono::duration<double>(decoder.Get<double>());
+    time_limit = has_time_limit ? std::optional(limit) : std::nullopt;
+  }
+
+  Mode mode = Mode::kAny;
+
+  // Stop once the best fitness is at or below this value.
+  std::optional<double> target_fitness;
+
+  // Stop after this many generations without a better best fitness. Zero
+  // disables the rule.
+  std::size_t stall_generations = 0;
+
+  // Stop once this many chromosomes have been simulated. Fitnesses served by
+  // the cache do not count. Zero disables the rule.
+  std::size_t max_evaluations = 0;
+
+  // Stop once this much wall time has passed since Start.
+  std::optional<std::chrono::duration<double>> time_limit;
+};
+
+// Tracks the progress of a run against its TerminationRules.
+class TerminationMonitor {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  TerminationMonitor()
+      : best_fitness_(std::numeric_limits<double>::infinity()),
+        num_stalled_(0),
+        num_evaluations_(0) {}
+
+  ~TerminationMonitor() = default;
+
+  constexpr const double best_fitness() const { return best_fitness_; }
+  constexpr const std::size_t num_stalled() const { return num_stalled_; }
+  constexpr const std::size_t num_evaluations() const {
+    return num_evaluations_;
+  }
+
+  // Starts the clock. Unless `keep_progress` is set, the best fitness and
+  // the stall and evaluation counts start over too.
+  void Restart(const bool keep_progress = false) {
+    if (!keep_progress) {
+      best_fitness_ = std::numeric_limits<double>::infinity();
+      num_stalled_ = 0;
+      num_evaluations_ = 0;
+    }
+
+    start_ = Clock::now();
+  }
+
+  void AddEvaluations(const std::size_t num_evaluations) {
+    num_evaluations_ += num_evaluations;
+  }
+
+  // Records the best fitness of a completed generation.
+  void Update(const double best_fitness) {
+    if (best_fitness < best_fitness_) {
+      best_fitness_ = best_fitness;
+      num_stalled_ = 0;
+    } else {
+      ++num_stalled_;
+    }
+  }
+
+  // The rules that stop the run, or zero to go on.
+  const unsigned Check(const TerminationRules& rules,
+                       const bool max_generations_reached,
+                       const bool stop_requested) const {
+    auto fired = (max_generations_reached ? TerminationRules::kMaxGenerations
+                                          : 0U) |
+                 (stop_requested ? TerminationRules::kStopRequested : 0U);
+
+    if (rules.target_fitness.has_value() &&
+        best_fitness_ <= rules.target_fitness.value()) {
+      fired |= TerminationRules::kTargetFitness;
+    }
+
+    if (rules.stall_generations != 0 &&
+        num_stalled_ >= rules.stall_generations) {
+      fired |= TerminationRules::kStall;
+    }
+
+    if (rules.max_evaluations != 0 &&
+        num_evaluations_ >= rules.max_evaluations) {
+      fired |= TerminationRules::kMaxEvaluations;
+    }
+
+    if (rules.time_limit.has_value() &&
+        Clock::now() - start_ >= rules.time_limit.value()) {
+      fired |= TerminationRules::kTimeLimit;
+    }
+
+    auto configured = rules.configured();
+    auto optional = fired & configured;
+    auto hard = fired & ~configured;
+    if (rules.mode == TerminationRules::Mode::kAll &&
+        optional != configured) {
+      optional = 0;
+    }
+
+    return hard | optional;
+  }
+
+  // The clock is not saved; a resumed run gets its time limit afresh.
+  void Save(CheckpointEncoder& encoder) const {
+    encoder.Put(best_fitness_);
+    encoder.Put(static_cast<std::uint64_t>(num_stalled_));
+    encoder.Put(static_cast<std::uint64_t>(num_evaluations_));
+  }
+
+  void Restore(CheckpointDecoder& decoder) {
+    best_fitness_ = decoder.Get<double>();
+    num_stalled_ = decoder.Get<std::uint64_t>();
+    num_evaluations_ = decoder.Get<std::uint64_t>();
+  }
+
+ private:
+  Clock::time_point start_;
+  double best_fitness_;
+  std::size_t num_stalled_;
+  std::size_t num_evaluations_;
+};
+
+}  // namespace ga
+
+#endif  // GA_TERMINATION_H_
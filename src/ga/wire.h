@@ -0,0 +1,309 @@
+#ifndef GA_WIRE_H_
+#define GA_WIRE_H_
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "ga/chromosome.h"
+
+namespace ga::wire {
+
+template <typename C>
+struct ChromosomeCodec;
+
+// Compact binary encoding of a chromosome: its N gene values followed by its
+// fitness, in host byte order. Processes exchanging it run on the same host.
+template <typename T, std::size_t N>
+struct ChromosomeCodec<Chromosome<T, N>> {
+  static constexpr const std::size_t kEncodedSize =
+      N * sizeof(T) + sizeof(double);
+
+  static void Encode(const Chromosome<T, N>& chromosome, std::uint8_t* out) {
+    for (std::size_t i = 0; i < N; ++i) {
+      std::memcpy(out + i * sizeof(T), &chromosome[i].value(), sizeof(T));
+    }
+
+    double fitness = chromosome.fitness();
+    std::memcpy(out + N * sizeof(T), &fitness, sizeof(double));
+  }
+
+  static const Chromosome<T, N> Decode(const std::uint8_t* in) {
+    auto chromosome = Chromosome<T, N>();
+    for (std::size_t i = 0; i < N; ++i) {
+      std::memcpy(&chromosome[i].value(), in + i * sizeof(T), sizeof(T));
+    }
+
+    std::memcpy(&chromosome.fitness(), in + N * sizeof(T), sizeof(double));
+
+    return chromosome;
+  }
+};
+
+struct Message {
+  enum class Type : std::uint8_t {
+    // Island to coordinator: the best fitness after a generation.
+    kProgress = 1,
+    // Either direction: encoded chromosomes migrating between islands.
+    kMigrants = 2,
+    // Island to coordinator: the island's final best chromosome.
+    kResult = 3,
+    // Coordinator to island: finish after the current generation. Also
+    // client to tuning daemon: cancel the job.
+    kStop = 4,
+    // Client to tuning daemon: an encoded control::TuningJob.
+    kJob = 5,
+    // Tuning daemon to client: why a job failed, as text.
+    kError = 6,
+  };
+
+  struct Header {
+    std::uint32_t payload_size;
+    Type type;
+    std::uint8_t reserved;
+    std::uint16_t island;
+    std::uint32_t generation;
+  };
+
+  static_assert(sizeof(Header) == 12, "Header must be packed");
+
+  // Receive drops peers announcing a larger payload rather than allocating
+  // it.
+  static constexpr const std::uint32_t kMaxPayloadSize = 1 << 24;
+
+  Message(const Type type = Type::kProgress, const std::uint16_t island = 0,
+          const std::uint32_t generation = 0)
+      : type(type), island(island), generation(generation) {}
+
+  ~Message() = default;
+
+  Type type;
+  std::uint16_t island;
+  std::uint32_t generation;
+  std::vector<std::uint8_t> payload;
+};
+
+// An owned socket descriptor.
+class Socket {
+ public:
+  explicit Socket(const int fd = -1) : fd_(fd) {}
+
+  Socket(Socket&& socket) : fd_(socket.fd_) { socket.fd_ = -1; }
+
+  Socket& operator=(Socket&& socket) {
+    if (this != &socket) {
+      close();
+      fd_ = socket.fd_;
+      socket.fd_ = -1;
+    }
+
+    return *this;
+  }
+
+  Socket(const Socket&) = delete;
+  Socket& operator=(const Socket&) = delete;
+
+  ~Socket() { close(); }
+
+  constexpr const int fd() const { return fd_; }
+  constexpr const bool is_open() const { return fd_ >= 0; }
+
+  void close() {
+    if (fd_ >= 0) {
+      ::close(fd_);
+      fd_ = -1;
+    }
+  }
+
+ private:
+  int fd_;
+};
+
+inline const sockaddr_un Address(const std::string& path) {
+  auto address = sockaddr_un();
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path)) {
+    throw std::system_error(ENAMETOOLONG, std::generic_category(), path);
+  }
+
+  std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+  return address;
+}
+
+// Binds a listening Unix domain socket at `path`, replacing a stale one.
+inline Socket Listen(const std::string& path, const int backlog) {
+  auto socket = Socket(::socket(AF_UNIX, SOCK_STREAM, 0));
+  if (!socket.is_open()) {
+    throw std::system_error(errno, std::generic_category(), "socket");
+  }
+
+  auto address = Address(path);
+  ::unlink(path.c_str());
+  if (::bind(socket.fd(), reinterpret_cast<const sockaddr*>(&address),
+             sizeof(address)) != 0 ||
+      ::listen(socket.fd(), backlog) != 0) {
+    throw std::system_error(errno, std::generic_category(), path);
+  }
+
+  return socket;
+}
+
+inline Socket Accept(const Socket& listener) {
+  auto socket = Socket(::accept(listener.fd(), nullptr, nullptr));
+  if (!socket.is_open()) {
+    throw std::system_error(errno, std::generic_category(), "accept");
+  }
+
+  return socket;
+}
+
+// Connects to the socket at `path`, retrying while it does not exist yet.
+inline Socket Connect(const std::string& path,
+                      const std::chrono::milliseconds timeout =
+                          std::chrono::milliseconds(5000)) {
+  auto address = Address(path);
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+
+  while (true) {
+    auto socket = Socket(::socket(AF_UNIX, SOCK_STREAM, 0));
+    if (!socket.is_open()) {
+      throw std::system_error(errno, std::generic_category(), "socket");
+    }
+
+    if (::connect(socket.fd(), reinterpret_cast<const sockaddr*>(&address),
+                  sizeof(address)) == 0) {
+      return socket;
+    }
+
+    if ((errno != ENOENT && errno != ECONNREFUSED) ||
+        std::chrono::steady_clock::now() >= deadline) {
+      throw std::system_error(errno, std::generic_category(), path);
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+}
+
+inline const bool WriteAll(const Socket& socket, const void* data,
+                           std::size_t size) {
+  auto bytes = static_cast<const std::uint8_t*>(data);
+  while (size > 0) {
+    auto written = ::send(socket.fd(), bytes, size, MSG_NOSIGNAL);
+    if (written < 0 && errno == EINTR) {
+      continue;
+    } else if (written <= 0) {
+      return false;
+    }
+
+    bytes += written;
+    size -= static_cast<std::size_t>(written);
+  }
+
+  return true;
+}
+
+inline const bool ReadAll(const Socket& socket, void* data, std::size_t size) {
+  auto bytes = static_cast<std::uint8_t*>(data);
+  while (size > 0) {
+    auto read = ::recv(socket.fd(), bytes, size, 0);
+    if (read < 0 && errno == EINTR) {
+      continue;
+    } else if (read <= 0) {
+      return false;
+    }
+
+    bytes += read;
+    size -= static_cast<std::size_t>(read);
+  }
+
+  return true;
+}
+
+// Appends `message` to `bytes` as Send writes it, for sockets that are
+// written with TrySend.
+inline void Encode(const Message& message, std::vector<std::uint8_t>& bytes) {
+  auto header = Message::Header();
+  header.payload_size = static_cast<std::uint32_t>(message.payload.size());
+  header.type = message.type;
+  header.reserved = 0;
+  header.island = message.island;
+  header.generation = message.generation;
+
+  auto offset = bytes.size();
+  bytes.resize(offset + sizeof(header) + message.payload.size());
+  std::memcpy(bytes.data() + offset, &header, sizeof(header));
+  std::memcpy(bytes.data() + offset + sizeof(header), message.payload.data(),
+              message.payload.size());
+}
+
+// Writes as much of `size` bytes as the socket takes without blocking and
+// returns how many that was. Returns -1 once the peer has gone away.
+inline const std::ptrdiff_t TrySend(const Socket& socket, const void* data,
+                                    const std::size_t size) {
+  while (true) {
+    auto written = ::send(socket.fd(), data, size, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (written >= 0) {
+      return written;
+    } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      return 0;
+    } else if (errno != EINTR) {
+      return -1;
+    }
+  }
+}
+
+// Returns false once the peer has gone away.
+inline const bool Send(const Socket& socket, const Message& message) {
+  auto header = Message::Header();
+  header.payload_size = static_cast<std::uint32_t>(message.payload.size());
+  header.type = message.type;
+  header.reserved = 0;
+  header.island = message.island;
+  header.generation = message.generation;
+
+  return WriteAll(socket, &header, sizeof(header)) &&
+         WriteAll(socket, message.payload.data(), message.payload.size());
+}
+
+// Blocks until a whole message arrives. Returns false once the peer has gone
+// away or announces a payload above Message::kMaxPayloadSize.
+inline const bool Receive(const Socket& socket, Message& message) {
+  auto header = Message::Header();
+  if (!ReadAll(socket, &header, sizeof(header)) ||
+      header.payload_size > Message::kMaxPayloadSize) {
+    return false;
+  }
+
+  message.type = header.type;
+  message.island = header.island;
+  message.generation = header.generation;
+  message.payload.resize(header.payload_size);
+
+  return ReadAll(socket, message.payload.data(), message.payload.size());
+}
+
+// Whether a message (or the end of the stream) can be read without blocking.
+inline const bool Readable(const Socket& socket, const int timeout_ms = 0) {
+  auto poll_fd = pollfd();
+  poll_fd.fd = socket.fd();
+  poll_fd.events = POLLIN;
+
+  return ::poll(&poll_fd, 1, timeout_ms) > 0 &&
+         (poll_fd.revents & (POLLIN | POLLHUP | POLLERR)) != 0;
+}
+
+}  // namespace ga::wire
+
+#endif  // GA_WIRE_H_
@@ -0,0 +1,342 @@
+#ifndef GA_WORK_POOL_H_
+#define GA_WORK_POOL_H_
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ga {
+
+// Runs the parallel loops of a Procedure, see Procedure::set_executor.
+class Executor {
+ public:
+  virtual ~Executor() = default;
+
+  // The number of tasks that can run at the same time.
+  virtual const std::size_t size() const = 0;
+
+  // Calls `task(i)` for every i in [0, count), possibly concurrently, and
+  // returns once all calls have returned. The calling thread takes part. The
+  // first exception a call throws is rethrown once all of them are done.
+  virtual void Run(const std::size_t count,
+                   const std::function<void(const std::size_t)>& task) = 0;
+};
+
+// A fixed set of threads shared by many jobs. Each thread owns a deque of
+// tasks: the tasks a thread spawns go to the back of its own deque, which it
+// works through last in, first out, while idle threads steal from the front
+// of the others' deques. Jobs are submitted with a priority and wait in a
+// shared queue until a thread is free; a thread always takes the task of
+// highest priority it can find, and the tasks a job spawns inherit its
+// priority. Running tasks are never preempted.
+class WorkPool : public Executor {
+ public:
+  // Zero threads uses every hardware thread.
+  explicit WorkPool(std::size_t num_threads = 0) : num_queued_(0) {
+    if (num_threads == 0) {
+      num_threads = std::max(1U, std::thread::hardware_concurrency());
+    }
+
+    workers_.reserve(num_threads);
+    for (std::size_t i = 0; i < num_threads; ++i) {
+      workers_.push_back(std::make_unique<Worker>());
+    }
+    for (std::size_t i = 0; i < num_threads; ++i) {
+      workers_[i]->thread =
+          std::jthread([this, i](std::stop_token stop) { Work(i, stop); });
+    }
+  }
+
+  WorkPool(const WorkPool&) = delete;
+  WorkPool& operator=(const WorkPool&) = delete;
+
+  // Waits for the running tasks; queued ones are dropped.
+  ~WorkPool() override {
+    {
+      auto lock = std::lock_guard(sleep_mutex_);
+      for (auto& worker : workers_) {
+        worker->thread.request_stop();
+      }
+    }
+    wake_.notify_all();
+
+    for (auto& worker : workers_) {
+      worker->thread.join();
+    }
+  }
+
+  const std::size_t size() const final { return workers_.size(); }
+
+  // Queues `task` to run on one of the threads, ahead of every queued task of
+  // lower priority. Tasks of equal priority start in submission order.
+  void Submit(std::function<void()> task, const int priority = 0) {
+    {
+      auto lock = std::lock_guard(queue_mutex_);
+      queue_.push_back(Task{std::move(task), nullptr, priority, sequence_++});
+      std::push_heap(queue_.begin(), queue_.end(), Later());
+    }
+
+    Queued(1);
+  }
+
+  void Run(const std::size_t count,
+           const std::function<void(const std::size_t)>& task) final {
+    if (count == 0) {
+      return;
+    }
+
+    auto group = Group{count, {}, {}, nullptr};
+    auto worker = current_pool_ == this ? current_worker_ : kNoWorker;
+    auto priority = current_priority_;
+
+    // The calling thread runs the first call; the others are queued where
+    // they can be stolen, its own deque or, off the pool, the shared queue.
+    if (count > 1) {
+      if (worker != kNoWorker) {
+        auto lock = std::lock_guard(workers_[worker]->mutex);
+        for (std::size_t i = 1; i < count; ++i) {
+          workers_[worker]->tasks.push_back(
+              Task{[&task, i] { task(i); }, &group, priority, 0});
+        }
+      } else {
+        auto lock = std::lock_guard(queue_mutex_);
+        for (std::size_t i = 1; i < count; ++i) {
+          queue_.push_back(
+              Task{[&task, i] { task(i); }, &group, priority, sequence_++});
+          std::push_heap(queue_.begin(), queue_.end(), Later());
+        }
+      }
+
+      Queued(count - 1);
+    }
+
+    auto first = Task{[&task] { task(0); }, &group, priority, 0};
+    Execute(first);
+
+    // Only calls of this Run are helped with, so that waiting never starts an
+    // unrelated job on this stack.
+    auto next = Task();
+    while (TakeFromGroup(worker, &group, next)) {
+      Execute(next);
+    }
+
+    auto lock = std::unique_lock(group.mutex);
+    group.done.wait(lock, [&group] { return group.remaining == 0; });
+    if (group.error) {
+      std::rethrow_exception(group.error);
+    }
+  }
+
+ private:
+  static constexpr const std::size_t kNoWorker =
+      std::numeric_limits<std::size_t>::max();
+
+  // The calls of one Run still to finish.
+  struct Group {
+    std::size_t remaining;
+    std::mutex mutex;
+    std::condition_variable done;
+    std::exception_ptr error;
+  };
+
+  struct Task {
+    std::function<void()> run;
+    Group* group = nullptr;
+    int priority = 0;
+    std::uint64_t sequence = 0;
+  };
+
+  // Orders the shared queue as a max-heap: highest priority, then oldest.
+  struct Later {
+    const bool operator()(const Task& t1, const Task& t2) const {
+      return t1.priority != t2.priority ? t1.priority < t2.priority
+                                        : t1.sequence > t2.sequence;
+    }
+  };
+
+  struct Worker {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+    std::jthread thread;
+  };
+
+  void Work(const std::size_t worker, const std::stop_token& stop) {
+    current_pool_ = this;
+    current_worker_ = worker;
+
+    while (!stop.stop_requested()) {
+      // Scoped to the iteration, so that what a task holds is released as
+      // soon as it is done.
+      auto task = Task();
+      if (Take(worker, task)) {
+        Execute(task);
+        continue;
+      }
+
+      auto lock = std::unique_lock(sleep_mutex_);
+      wake_.wait(lock, [this, &stop] {
+        return stop.stop_requested() || num_queued_ > 0;
+      });
+    }
+  }
+
+  void Execute(Task& task) {
+    auto priority = current_priority_;
+    current_priority_ = task.priority;
+
+    if (!task.group) {
+      task.run();
+    } else {
+      auto* group = task.group;
+      try {
+        task.run();
+      } catch (...) {
+        auto lock = std::lock_guard(group->mutex);
+        if (!group->error) {
+          group->error = std::current_exception();
+        }
+      }
+
+      // Notified under the lock, so that the waiting Run cannot return and
+      // destroy the group before this thread is done with it.
+      auto lock = std::lock_guard(group->mutex);
+      if (--group->remaining == 0) {
+        group->done.notify_all();
+      }
+    }
+
+    current_priority_ = priority;
+  }
+
+  // The newest task of this thread's own deque, or the task of highest
+  // priority among the oldest of every other deque and the shared queue.
+  // Stolen tasks win ties, so running jobs finish before new ones start.
+  const bool Take(const std::size_t worker, Task& task) {
+    {
+      auto lock = std::lock_guard(workers_[worker]->mutex);
+      auto& tasks = workers_[worker]->tasks;
+      if (!tasks.empty()) {
+        task = std::move(tasks.back());
+        tasks.pop_back();
+        Dequeued();
+        return true;
+      }
+    }
+
+    auto victim = kNoWorker;
+    auto priority = std::numeric_limits<int>::min();
+    for (std::size_t i = 0; i < workers_.size(); ++i) {
+      auto lock = std::lock_guard(workers_[i]->mutex);
+      auto& tasks = workers_[i]->tasks;
+      if (i != worker && !tasks.empty() &&
+          (victim == kNoWorker || tasks.front().priority > priority)) {
+        victim = i;
+        priority = tasks.front().priority;
+      }
+    }
+
+    {
+      auto lock = std::lock_guard(queue_mutex_);
+      if (!queue_.empty() &&
+          (victim == kNoWorker || queue_.front().priority > priority)) {
+        std::pop_heap(queue_.begin(), queue_.end(), Later());
+        task = std::move(queue_.back());
+        queue_.pop_back();
+        Dequeued();
+        return true;
+      }
+    }
+
+    if (victim != kNoWorker) {
+      auto lock = std::lock_guard(workers_[victim]->mutex);
+      auto& tasks = workers_[victim]->tasks;
+      if (!tasks.empty()) {
+        task = std::move(tasks.front());
+        tasks.pop_front();
+        Dequeued();
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  // A queued call of `group`. Calls spawned on a worker sit at the back of
+  // its own deque until they are taken, by it or by thieves from the front.
+  const bool TakeFromGroup(const std::size_t worker, const Group* group,
+                           Task& task) {
+    if (worker != kNoWorker) {
+      auto lock = std::lock_guard(workers_[worker]->mutex);
+      auto& tasks = workers_[worker]->tasks;
+      if (tasks.empty() || tasks.back().group != group) {
+        return false;
+      }
+
+      task = std::move(tasks.back());
+      tasks.pop_back();
+    } else {
+      auto lock = std::lock_guard(queue_mutex_);
+      auto found = std::find_if(
+          queue_.begin(), queue_.end(),
+          [group](const Task& queued) { return queued.group == group; });
+      if (found == queue_.end()) {
+        return false;
+      }
+
+      task = std::move(*found);
+      queue_.erase(found);
+      std::make_heap(queue_.begin(), queue_.end(), Later());
+    }
+
+    Dequeued();
+    return true;
+  }
+
+  // Counted under the sleep lock's protection, so that no thread goes to
+  // sleep between the count and the wake-up.
+  void Queued(const std::size_t count) {
+    {
+      auto lock = std::lock_guard(sleep_mutex_);
+      num_queued_ += count;
+    }
+
+    if (count == 1) {
+      wake_.notify_one();
+    } else {
+      wake_.notify_all();
+    }
+  }
+
+  void Dequeued() {
+    auto lock = std::lock_guard(sleep_mutex_);
+    --num_queued_;
+  }
+
+  inline static thread_local WorkPool* current_pool_ = nullptr;
+  inline static thread_local std::size_t current_worker_ = kNoWorker;
+  inline static thread_local int current_priority_ = 0;
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+
+  std::mutex queue_mutex_;
+  std::vector<Task> queue_;
+  std::uint64_t sequence_ = 0;
+
+  std::mutex sleep_mutex_;
+  std::condition_variable wake_;
+  std::size_t num_queued_;
+};
+
+}  // namespace ga
+
+#endif  // GA_WORK_POOL_H_
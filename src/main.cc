@@ -1,18 +1,496 @@
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 #include "control/plant_control.h"
+#include "control/scenario.h"
 #include "control/solver.h"
+#include "control/trace.h"
+#include "control/tuning_batch.h"
+#include "control/tuning_daemon.h"
+#include "control/tuning_job.h"
+#include "ga/island_model.h"
+#include "ga/metrics_exporter.h"
+#include "ga/process_island.h"
+#include "ga/random.h"
+
+namespace {
+
+using Solver = control::Solver<double, 3>;
+
+// The exporters of `--metrics-json` and `--metrics-prom`, for the names that
+// are set.
+std::vector<std::unique_ptr<ga::MetricsObserver>> MakeExporters(
+    const std::string& json_file_name, const std::string& prom_file_name) {
+  auto exporters = std::vector<std::unique_ptr<ga::MetricsObserver>>();
+  if (!json_file_name.empty()) {
+    exporters.push_back(
+        std::make_unique<ga::JsonLinesExporter>(json_file_name));
+  }
+  if (!prom_file_name.empty()) {
+    exporters.push_back(
+        std::make_unique<ga::PrometheusExporter>(prom_file_name));
+  }
+
+  return exporters;
+}
+
+// Runs a coordinator in this process and one forked process per island, all
+// talking over a Unix domain socket. Every island stops by
+// `termination_rules`, and the coordinator stops them all once one reaches
+// the target fitness. Island i exports its metrics to the metrics file names
+// with "_i" inserted, see ga::IslandFileName.
+const Solver::chromosome_type StartProcessIslands(
+    const std::size_t num_islands, const Solver::Args& args,
+    const std::vector<Solver::bounds_type>& constraints,
+    const std::string& log_file_name,
+    const ga::TerminationRules& termination_rules,
+    const std::string& metrics_json_file_name,
+    const std::string& metrics_prom_file_name) {
+  auto socket_path =
+      "/tmp/pid-control-ga-" + std::to_string(::getpid()) + ".sock";
+  // Under Mode::kAll the target alone does not stop a run.
+  auto target_fitness =
+      termination_rules.mode == ga::TerminationRules::Mode::kAny
+          ? termination_rules.target_fitness.value_or(
+                -std::numeric_limits<double>::infinity())
+          : -std::numeric_limits<double>::infinity();
+  auto coordinator = ga::Coordinator<Solver::chromosome_type>(
+      socket_path, num_islands, target_fitness);
+  coordinator.log_file_name() = log_file_name;
+  auto migration = ga::IslandModel<Solver>::Args(num_islands);
+
+  std::cout.flush();
+
+  auto children = std::vector<pid_t>();
+  for (std::size_t i = 0; i < num_islands; ++i) {
+    auto pid = ::fork();
+    if (pid == 0) {
+      try {
+        auto island_args = args;
+        island_args.seed = ga::DeriveSeed(args.seed, i);
+        auto island = ga::RemoteIsland<Solver>(socket_path, migration,
+                                               island_args, constraints);
+        island.termination_rules() = termination_rules;
+
+        auto exporters = MakeExporters(
+            metrics_json_file_name.empty()
+                ? std::string()
+                : ga::IslandFileName(metrics_json_file_name, i),
+            metrics_prom_file_name.empty()
+                ? std::string()
+                : ga::IslandFileName(metrics_prom_file_name, i));
+        for (auto& exporter : exporters) {
+          island.AddMetricsObserver(exporter.get());
+        }
+
+        island.Run();
+      } catch (const std::exception& e) {
+        std::cerr << "Island " << i << " failed:\t" << e.what() << std::endl;
+        ::_exit(1);
+      }
+      ::_exit(0);
+    }
+
+    children.push_back(pid);
+  }
+
+  auto solution = Solver::chromosome_type();
+  try {
+    solution = coordinator.Start();
+  } catch (...) {
+    for (auto pid : children) {
+      ::kill(pid, SIGTERM);
+    }
+    for (auto pid : children) {
+      ::waitpid(pid, nullptr, 0);
+    }
+    throw;
+  }
+
+  for (auto pid : children) {
+    ::waitpid(pid, nullptr, 0);
+  }
+
+  return solution;
+}
+
+// Runs `job` on the daemon at `socket_path`, printing its progress, and
+// cancels it after `cancel_after` generations if that is non-zero.
+int SubmitJob(const std::string& socket_path, const control::TuningJob& job,
+              const std::size_t cancel_after) {
+  try {
+    auto result = control::SubmitTuningJob(
+        socket_path, job,
+        [cancel_after](const std::uint32_t generation, const double fitness) {
+          std::cout << "Generation " << generation << ":\t" << fitness
+                    << std::endl;
+          return cancel_after == 0 || generation < cancel_after;
+        });
+
+    std::cout << "Seed:\t\t" << result.seed << std::endl;
+    std::cout << "Stopped by:\t"
+              << ga::TerminationRules::Describe(result.termination_reason)
+              << std::endl;
+    std::cout << "Solution:\t" << result.solution << std::endl;
+    std::cout << "Fitness:\t" << result.solution.fitness() << std::endl;
+  } catch (const std::exception& e) {
+    std::cerr << "Job failed:\t" << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
+
+// Runs the jobs of `jobs_file_name` on `num_threads` threads, reporting each
+// as it finishes, and writes all their results to `results_file_name`.
+int RunBatch(const std::string& jobs_file_name,
+             const std::string& results_file_name,
+             const control::TuningJob& defaults,
+             const std::size_t num_threads) {
+  auto jobs = std::vector<control::BatchJob>();
+  try {
+    jobs = control::ReadTuningJobs(jobs_file_name, defaults);
+  } catch (const std::exception& e) {
+    std::cerr << "Bad jobs file:\t" << e.what() << std::endl;
+    return 1;
+  }
+
+  auto batch = control::TuningBatch(jobs, num_threads);
+  std::cout << "Jobs:\t\t" << batch.jobs().size() << " on "
+            << batch.num_threads() << " threads" << std::endl;
+
+  std::size_t num_done = 0;
+  std::size_t num_failed = 0;
+  auto results = batch.Run([&](const std::size_t index,
+                               const control::BatchResult& result) {
+    std::cout << "[" << ++num_done << "/" << batch.jobs().size() << "] "
+              << batch.jobs()[index].name << ":\t";
+    if (result.error.empty()) {
+      std::cout << result.result.solution << " "
+                << result.result.solution.fitness();
+    } else {
+      ++num_failed;
+      std::cout << "failed: " << result.error;
+    }
+    std::cout << " (" << result.num_workers << " workers, " << result.seconds
+              << " s)" << std::endl;
+  });
+
+  control::TuningBatch::WriteResults(results_file_name, batch.jobs(), results);
+  std::cout << "Results:\t" << results_file_name << std::endl;
+
+  return num_failed == 0 ? 0 : 1;
+}
+
+}  // namespace
 
 int main(const int argc, const char* const argv[]) {
-  auto args = ga::Procedure<double, 3>::Args();
+  // `--trace-to-csv TRACE CSV` only converts a binary trace written by
+  // `--trace` to CSV.
+  if (argc == 4 && std::string(argv[1]) == "--trace-to-csv") {
+    control::MappedTrace(argv[2]).WriteCsv(argv[3]);
+    return 0;
+  }
+
+  auto args = Solver::Args();
+
+  auto constraints = std::vector<Solver::bounds_type>{
+      Solver::bounds_type(2, 18), Solver::bounds_type(1.05, 9.42),
+      Solver::bounds_type(0.26, 2.37)};
+
+  // `--islands N` spreads the search over N island processes and
+  // `--island-threads N` over N islands on threads of this process.
+  // `--workers N` evaluates each generation on N threads, every hardware
+  // thread for zero.
+  // `--selection fps|tournament|rank` picks the parent selection scheme and
+  // `--tournament-size K` the size of tournaments.
+  // `--screening F` screens offspring with a cheap simulation and only
+  // evaluates the best fraction F of them at full fidelity.
+  // `--screening-horizon SECONDS` and `--screening-sample-time SECONDS` set
+  // the timing of the screening simulations of a single-process run.
+  // `--surrogate F` only simulates the fraction F of the offspring that a
+  // surrogate model fitted to earlier simulations rates as most promising.
+  // `--metrics-json FILE` and `--metrics-prom FILE` export per-generation
+  // metrics as JSON lines and Prometheus text, one file per island process
+  // under `--islands`.
+  // `--log FILE` moves the fitness log and an empty name disables it.
+  // `--log-format csv|binary` picks the format of a single-process log.
+  // `--checkpoint FILE` saves the state of a single-process run every
+  // Solver::kDefaultCheckpointInterval generations and `--resume FILE`
+  // continues one.
+  // `--target-fitness F`, `--stall K`, `--max-evaluations M` and
+  // `--time-limit SECONDS` stop a run early, as soon as any of them fires
+  // or, with `--stop-when any|all` set to all, once all of them have. Every
+  // island stops by them on its own, and any island reaching the target
+  // stops them all.
+  // `--scenarios FILE` tunes a single-process run for every scenario of the
+  // file, see control::ReadScenarios, and `--aggregate mean|worst|weighted`
+  // picks how the fitnesses of the scenarios combine.
+  // `--precision double|float` set to float simulates a single-process run
+  // in single precision and `--verify-elites K` simulates its best K
+  // chromosomes again in double once it stops.
+  // `--seed S` makes the run reproducible; without it a random seed is drawn
+  // and printed.
+  // `--trace FILE` also writes the solution's step response as a binary
+  // trace.
+  // `--daemon SOCKET` serves tuning jobs on a Unix domain socket until it is
+  // killed, on `--threads N` pool threads, and `--submit SOCKET` sends the
+  // run the other options describe to such a daemon as a job instead of
+  // running it here. A job also takes `--plant "B0 B1 ... / A0 A1 ..."`, a
+  // transfer function of up to control::TuningJob::kMaxPlantOrder, with
+  // `--dead-time SECONDS`, `--priority P` to start ahead of queued jobs of
+  // lower priority and `--cancel-after G` to cancel it after G generations.
+  // `--batch FILE` runs every job of the file, see control::ReadTuningJobs,
+  // on `--threads N` threads, the other options giving the defaults of every
+  // job, and writes their results to `--results FILE`.
+  // An unknown option, or a value that does not parse, ends the program with
+  // a non-zero exit status.
+  std::size_t num_islands = 0;
+  std::size_t num_island_threads = 0;
+  std::string metrics_json_file_name;
+  std::string metrics_prom_file_name;
+  std::string log_file_name = "fitnesses.csv";
+  auto log_format = ga::LogFormat::kCsv;
+  std::string trace_file_name;
+  std::string checkpoint_file_name;
+  std::string resume_file_name;
+  auto termination_rules = ga::TerminationRules();
+  auto screening_timing = Solver::kDefaultScreeningTiming;
+  auto scenarios = std::vector<control::Scenario>(1);
+  auto aggregate = control::Aggregate::kMean;
+  auto precision = control::Precision::kDouble;
+  std::size_t num_verified_elites = 0;
+  std::string daemon_socket_path;
+  std::string submit_socket_path;
+  std::size_t num_threads = 0;
+  auto job = control::TuningJob();
+  std::size_t cancel_after = 0;
+  std::string batch_file_name;
+  std::string results_file_name = "results.csv";
+  for (int i = 1; i < argc; i += 2) {
+    auto option = std::string(argv[i]);
+    if (i + 1 == argc) {
+      std::cerr << "Missing value for " << option << std::endl;
+      return 1;
+    }
+
+    try {
+      if (option == "--islands") {
+        num_islands = std::stoul(argv[i + 1]);
+      } else if (option == "--island-threads") {
+        num_island_threads = std::stoul(argv[i + 1]);
+      } else if (option == "--workers") {
+        args.num_workers = std::stoul(argv[i + 1]);
+      } else if (option == "--selection") {
+        auto selection = std::string(argv[i + 1]);
+        if (selection == "fps") {
+          args.selection = Solver::Selection::kFitnessProportionate;
+        } else if (selection == "tournament") {
+          args.selection = Solver::Selection::kTournament;
+        } else if (selection == "rank") {
+          args.selection = Solver::Selection::kRank;
+        } else {
+          throw std::invalid_argument(selection);
+        }
+      } else if (option == "--tournament-size") {
+        args.tournament_size = std::stoul(argv[i + 1]);
+      } else if (option == "--screening") {
+        args.screening_fraction = std::stod(argv[i + 1]);
+      } else if (option == "--surrogate") {
+        args.surrogate_fraction = std::stod(argv[i + 1]);
+      } else if (option == "--screening-horizon") {
+        screening_timing.simulation_time = std::stod(argv[i + 1]);
+      } else if (option == "--screening-sample-time") {
+        screening_timing.sample_time = std::stod(argv[i + 1]);
+      } else if (option == "--metrics-json") {
+        metrics_json_file_name = argv[i + 1];
+      } else if (option == "--metrics-prom") {
+        metrics_prom_file_name = argv[i + 1];
+      } else if (option == "--checkpoint") {
+        checkpoint_file_name = argv[i + 1];
+      } else if (option == "--resume") {
+        resume_file_name = argv[i + 1];
+      } else if (option == "--target-fitness") {
+        termination_rules.target_fitness = std::stod(argv[i + 1]);
+      } else if (option == "--stall") {
+        termination_rules.stall_generations = std::stoul(argv[i + 1]);
+      } else if (option == "--max-evaluations") {
+        termination_rules.max_evaluations = std::stoul(argv[i + 1]);
+      } else if (option == "--time-limit") {
+        termination_rules.time_limit =
+            std::chrono::duration<double>(std::stod(argv[i + 1]));
+      } else if (option == "--stop-when") {
+        auto mode = std::string(argv[i + 1]);
+        if (mode == "any") {
+          termination_rules.mode = ga::TerminationRules::Mode::kAny;
+        } else if (mode == "all") {
+          termination_rules.mode = ga::TerminationRules::Mode::kAll;
+        } else {
+          throw std::invalid_argument(mode);
+        }
+      } else if (option == "--scenarios") {
+        scenarios = control::ReadScenarios(argv[i + 1]);
+      } else if (option == "--aggregate") {
+        auto name = std::string(argv[i + 1]);
+        if (name == "mean") {
+          aggregate = control::Aggregate::kMean;
+        } else if (name == "worst") {
+          aggregate = control::Aggregate::kWorst;
+        } else if (name == "weighted") {
+          aggregate = control::Aggregate::kWeighted;
+        } else {
+          throw std::invalid_argument(name);
+        }
+      } else if (option == "--precision") {
+        auto name = std::string(argv[i + 1]);
+        if (name == "double") {
+          precision = control::Precision::kDouble;
+        } else if (name == "float") {
+          precision = control::Precision::kFloat;
+        } else {
+          throw std::invalid_argument(name);
+        }
+      } else if (option == "--verify-elites") {
+        num_verified_elites = std::stoul(argv[i + 1]);
+      } else if (option == "--seed") {
+        args.seed = std::stoull(argv[i + 1]);
+      } else if (option == "--trace") {
+        trace_file_name = argv[i + 1];
+      } else if (option == "--log") {
+        log_file_name = argv[i + 1];
+      } else if (option == "--log-format") {
+        auto name = std::string(argv[i + 1]);
+        if (name == "csv") {
+          log_format = ga::LogFormat::kCsv;
+        } else if (name == "binary") {
+          log_format = ga::LogFormat::kBinary;
+        } else {
+          throw std::invalid_argument(name);
+        }
+      } else if (option == "--daemon") {
+        daemon_socket_path = argv[i + 1];
+      } else if (option == "--threads") {
+        num_threads = std::stoul(argv[i + 1]);
+      } else if (option == "--submit") {
+        submit_socket_path = argv[i + 1];
+      } else if (option == "--plant") {
+        job.ParsePlant(argv[i + 1]);
+      } else if (option == "--dead-time") {
+        job.dead_time = std::stod(argv[i + 1]);
+      } else if (option == "--priority") {
+        job.priority = std::stoi(argv[i + 1]);
+      } else if (option == "--cancel-after") {
+        cancel_after = std::stoul(argv[i + 1]);
+      } else if (option == "--batch") {
+        batch_file_name = argv[i + 1];
+      } else if (option == "--results") {
+        results_file_name = argv[i + 1];
+      } else {
+        std::cerr << "Unknown option:\t" << option << std::endl;
+        return 1;
+      }
+    } catch (const std::logic_error&) {
+      std::cerr << "Bad value for " << option << ":\t" << argv[i + 1]
+                << std::endl;
+      return 1;
+    }
+  }
+
+  if (!daemon_socket_path.empty()) {
+    auto daemon = control::TuningDaemon(daemon_socket_path, num_threads);
+    std::cout << "Serving:\t" << daemon_socket_path << " on "
+              << daemon.pool().size() << " threads" << std::endl;
+    daemon.Serve();
+    return 0;
+  }
+
+  job.args = args;
+  job.constraints = constraints;
+  job.scenarios = scenarios;
+  job.aggregate = aggregate;
+  job.precision = precision;
+  job.num_verified_elites = num_verified_elites;
+  job.termination_rules = termination_rules;
+  if (!batch_file_name.empty()) {
+    return RunBatch(batch_file_name, results_file_name, job, num_threads);
+  }
+
   std::cout << args << std::endl;
 
-  auto constraints = {ga::Gene<double>::Bounds(2, 18),
-                      ga::Gene<double>::Bounds(1.05, 9.42),
-                      ga::Gene<double>::Bounds(0.26, 2.37)};
+  if (!submit_socket_path.empty()) {
+    std::cout << termination_rules << std::endl;
+
+    return SubmitJob(submit_socket_path, job, cancel_after);
+  }
+
+  auto solution = Solver::chromosome_type();
+  if (num_islands > 0) {
+    std::cout << "Islands:\t" << num_islands << std::endl;
+    std::cout << termination_rules << std::endl;
+    solution = StartProcessIslands(num_islands, args, constraints,
+                                   log_file_name, termination_rules,
+                                   metrics_json_file_name,
+                                   metrics_prom_file_name);
+  } else if (num_island_threads > 0) {
+    auto model = ga::IslandModel<Solver>(
+        ga::IslandModel<Solver>::Args(num_island_threads), args, constraints);
+    model.log_file_name() = log_file_name;
+    model.termination_rules() = termination_rules;
+    std::cout << model.args() << std::endl;
+    std::cout << termination_rules << std::endl;
+    solution = model.Start();
+  } else {
+    auto solver = Solver(args, constraints);
+    solver.log_file_name() = log_file_name;
+    solver.log_format() = log_format;
+    solver.checkpoint_file_name() = checkpoint_file_name;
+    solver.termination_rules() = termination_rules;
+    solver.screening_timing() = screening_timing;
+    solver.scenarios() = scenarios;
+    solver.aggregate() = aggregate;
+    solver.precision() = precision;
+    solver.num_verified_elites() = num_verified_elites;
+    if (scenarios.size() > 1) {
+      std::cout << "Scenarios:\t" << scenarios.size() << std::endl;
+    }
+    if (precision == control::Precision::kFloat) {
+      std::cout << "Precision:\tfloat, " << num_verified_elites
+                << " elites verified in double" << std::endl;
+    }
+    std::cout << termination_rules << std::endl;
+    if (!resume_file_name.empty()) {
+      solver.Resume(resume_file_name);
+    }
+
+    auto exporters =
+        MakeExporters(metrics_json_file_name, metrics_prom_file_name);
+    for (auto& exporter : exporters) {
+      solver.AddMetricsObserver(exporter.get());
+    }
+
+    solution = solver.Start();
 
-  auto solver = control::Solver<double, 3>(args, constraints);
-  auto solution = solver.Start();
+    if (args.seed == 0) {
+      std::cout << "Seed:\t\t" << solver.args().seed << std::endl;
+    }
+    std::cout << "Stopped by:\t"
+              << ga::TerminationRules::Describe(solver.termination_reason())
+              << std::endl;
+    std::cout << "Cache hits:\t" << solver.cache().hits() << "/"
+              << solver.cache().hits() + solver.cache().misses() << std::endl;
+  }
 
   auto pc = control::PlantControl();
   pc.controller().params().k_p = solution[0].value();
@@ -26,6 +504,9 @@ int main(const int argc, const char* const argv[]) {
   std::cout << "ISE:\t\t" << pc.IntegralSquaredError(response) << std::endl;
 
   pc.WriteResponseToFile("time_values.csv", response);
+  if (!trace_file_name.empty()) {
+    control::WriteTrace(trace_file_name, response);
+  }
 
   return 0;
-}
\ No newline at end of file
+}